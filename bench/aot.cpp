@@ -0,0 +1,79 @@
+// Run time of scripts under the interpreter versus the same scripts built
+// ahead of time with --emit-cpp (`make <script>.aot`): recursion, a numeric
+// loop and string building. Run from the repository root after `make`.
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static const struct {
+    const char* name;
+    const char* source;
+} scripts[] = {
+    {"fib", "fn fib(n) {\n"
+            "    while n < 2 {\n"
+            "        return n\n"
+            "    }\n"
+            "    return fib(n - 1) + fib(n - 2)\n"
+            "}\n"
+            "print(fib(25))\n"},
+    {"sumsq", "fn sumsq(n) {\n"
+              "    s = 0\n"
+              "    for i in range(n) {\n"
+              "        s = s + i * i % 7\n"
+              "    }\n"
+              "    return s\n"
+              "}\n"
+              "print(sumsq(300000))\n"},
+    {"strings", "s = \"\"\n"
+                "for i in range(20000) {\n"
+                "    s = s + i % 10\n"
+                "}\n"
+                "print(len(s))\n"},
+};
+
+// Runs `command`, returning its wall time and stdout.
+static double run(const std::string& command, std::string& out) {
+    auto start = Clock::now();
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return -1;
+    out.clear();
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) out.append(buffer, n);
+    int status = pclose(pipe);
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    return status == 0 ? secs : -1;
+}
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / ("servo-aot-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+    int status = 0;
+    for (auto& script : scripts) {
+        std::string base = (dir / script.name).string();
+        std::ofstream(base + ".sv") << script.source;
+        std::string build_log;
+        if (run("make -s " + base + ".aot 2>&1", build_log) < 0) {
+            std::cout << script.name << ": build failed\n" << build_log;
+            status = 1;
+            continue;
+        }
+        std::string interpreted, compiled;
+        double secs_interpreted = run("./servocomp " + base + ".sv", interpreted);
+        double secs_compiled = run(base + ".aot", compiled);
+        std::cout << script.name << ": interpreted " << secs_interpreted << " s, --emit-cpp " << secs_compiled << " s" << std::endl;
+        if (interpreted != compiled || secs_interpreted < 0 || secs_compiled < 0) {
+            std::cout << "  MISMATCH: " << interpreted << " vs " << compiled << std::endl;
+            status = 1;
+        }
+    }
+    fs::remove_all(dir);
+    return status;
+}
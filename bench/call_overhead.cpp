@@ -0,0 +1,63 @@
+// Measures the cost of one interpreted call to a user function taking 0, 1, 4
+// and 8 arguments, and counts heap allocations made per call.
+#include "servo/internal/private/parser.hpp"
+#include "servo/internal/private/expressionparser.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+static std::string params(int n) {
+    std::string out;
+    for (int i = 0; i < n; ++i) out += (i ? ", a" : "a") + std::to_string(i);
+    return out;
+}
+
+static std::string values(int n) {
+    std::string out;
+    for (int i = 0; i < n; ++i) out += (i ? ", " : "") + std::to_string(i + 1);
+    return out;
+}
+
+int main() {
+    const int counts[] = {0, 1, 4, 8};
+    const int iterations = 1000000;
+
+    std::string src;
+    for (int n : counts) {
+        src += "fn f" + std::to_string(n) + "(" + params(n) + ") {\n";
+        src += n ? "    return a" + std::to_string(n - 1) + "\n" : "    return 1\n";
+        src += "}\n";
+    }
+    servo::Parser p(servo::File("virtual", src));
+    p.parse().execute();
+
+    for (int n : counts) {
+        auto call = servo::ExpressionParser("f" + std::to_string(n) + "(" + values(n) + ")").parse();
+        call->evaluate(&p); // warm the inline cache
+
+        size_t before = allocations.load();
+        auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) call->evaluate(&p);
+        double secs = std::chrono::duration<double>(Clock::now() - start).count();
+        size_t allocs = allocations.load() - before;
+
+        std::cout << n << " args: " << secs * 1e9 / iterations << " ns/call, "
+                  << static_cast<double>(allocs) / iterations << " allocs/call" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Builds, indexes and probes lists and maps of growing size; per-operation
+// cost should stay flat as n doubles (amortized O(1) append / set / lookup).
+#include "servo/internal/private/parser.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static const char* source = R"(
+fn work(n) {
+    xs = []
+    m = {}
+    for i in range(n) {
+        append(xs, i)
+        m[i] = i
+    }
+    s = 0
+    for i in range(n) {
+        s = s + xs[i] + m[i]
+        while i in m {
+            remove(m, i)
+        }
+    }
+    return s + len(m)
+}
+)";
+
+int main() {
+    for (long n : {20000L, 40000L, 80000L}) {
+        servo::Parser p(servo::File("virtual", std::string(source) + "r = work(" + std::to_string(n) + ")\n"));
+        auto start = Clock::now();
+        p.parse().execute();
+        double secs = std::chrono::duration<double>(Clock::now() - start).count();
+        std::string r = servo::Expression::toString(p.findVariable("r")->value).str();
+        if (r != std::to_string(n * (n - 1))) {
+            std::cout << "MISMATCH: " << r << std::endl;
+            return 1;
+        }
+        std::cout << "n=" << n << ": " << secs << " s, " << secs / n * 1e9 << " ns per element" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Reads 10k small files from a script, once through system_file.read and once
+// by spawning `cat` per file through systemreturn, and compares the results.
+#include "servo/internal/private/parser.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static const int files = 10000;
+
+static std::string run(const std::string& read_expr, double& secs) {
+    std::string src = "total = 0\n"
+                      "for i in range(" + std::to_string(files) + ") {\n"
+                      "    total = total + " + read_expr + "\n"
+                      "}\n";
+    servo::Parser p(servo::File("virtual", src));
+    auto start = Clock::now();
+    p.parse().execute();
+    secs = std::chrono::duration<double>(Clock::now() - start).count();
+    return servo::Expression::toString(p.findVariable("total")->value).str();
+}
+
+int main() {
+    namespace fs = std::filesystem;
+    std::string dir = (fs::temp_directory_path() / ("servo-file-io-" + std::to_string(getpid()))).string();
+    fs::create_directories(dir);
+    for (int i = 0; i < files; ++i) std::ofstream(dir + "/" + std::to_string(i)) << i;
+
+    double native_secs, shell_secs;
+    std::string native = run("system_file.read(\"" + dir + "/\" + i)", native_secs);
+    std::string shell = run("systemreturn(\"cat " + dir + "/\" + i)", shell_secs);
+    fs::remove_all(dir);
+
+    std::cout << files << " files: system_file.read " << native_secs << " s, systemreturn(cat) " << shell_secs
+              << " s (" << shell_secs / native_secs << "x)" << std::endl;
+    if (native != shell) {
+        std::cout << "  MISMATCH: " << native << " vs " << shell << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Runs an integer arithmetic-heavy, a float arithmetic-heavy and a call-heavy
+// servo workload through the interpreter and with the baseline JIT, and
+// checks both give the same result.
+#include "servo/internal/private/parser.hpp"
+#include "servo/internal/private/jit.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static const char* source = R"(
+fn sumsq(n) {
+    s = 0
+    for i in range(n) {
+        s = s + i * i % 7 - i / 3
+    }
+    return s
+}
+fn damp(n, x) {
+    for i in range(n) {
+        x = x * 0.5 + 0.37
+    }
+    return x
+}
+fn fib(n) {
+    while n < 2 {
+        return n
+    }
+    return fib(n - 1) + fib(n - 2)
+}
+)";
+
+static std::string run(const std::string& call, bool jit, double& secs) {
+    servo::Jit::enabled = jit;
+    servo::Parser p(servo::File("virtual", std::string(source) + "r = " + call + "\n"));
+    auto start = Clock::now();
+    p.parse().execute();
+    secs = std::chrono::duration<double>(Clock::now() - start).count();
+    return servo::Expression::toString(p.findVariable("r")->value).str();
+}
+
+int main() {
+    const char* workloads[][2] = {
+        {"arithmetic", "sumsq(300000)"},
+        {"float", "damp(300000, 1.5)"},
+        {"calls", "fib(22)"},
+    };
+    for (auto& w : workloads) {
+        double interp_secs, jit_secs;
+        std::string expected = run(w[1], false, interp_secs);
+        std::string actual = run(w[1], true, jit_secs);
+        std::cout << w[0] << " " << w[1] << ": interpreter " << interp_secs << " s, jit " << jit_secs
+                  << " s (" << interp_secs / jit_secs << "x)" << std::endl;
+        if (expected != actual) {
+            std::cout << "  MISMATCH: " << expected << " vs " << actual << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Startup time of a script importing a synthetic 500-module graph (a binary
+// tree of modules, each defining a few functions), compiling the modules
+// one at a time, ahead of execution on a thread pool, and lazily (only the
+// root module is used, so only it is loaded).
+#include "servo/internal/private/parser.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static const int modules = 500;
+
+static void writeModule(const std::string& dir, int i) {
+    std::ofstream f(dir + "/mod" + std::to_string(i) + ".sv");
+    for (int child : {2 * i + 1, 2 * i + 2}) {
+        if (child < modules) f << "<import mod" << child << ">\n";
+    }
+    f << "value = " << i << "\n";
+    for (int fn = 0; fn < 8; ++fn) {
+        f << "fn f" << fn << "(a, b) {\n"
+          << "    s = 0\n"
+          << "    for k in range(a) {\n"
+          << "        s = s + k * b - " << fn << " % 3\n"
+          << "    }\n"
+          << "    while s > 1000 {\n"
+          << "        s = s / 2\n"
+          << "    }\n"
+          << "    return s + \"" << std::string(40, 'x') << "\"\n"
+          << "}\n";
+    }
+}
+
+// Each run is on a fresh thread, so it starts with an empty module cache.
+static double run(unsigned threads, bool lazy, std::string& result) {
+    double secs = 0;
+    std::thread([&] {
+        servo::Parser::load_threads = threads;
+        servo::Parser::lazy_imports = lazy;
+        servo::Parser p(servo::File("virtual", std::string("<import mod0>\nr = mod0.value\n")));
+        auto start = Clock::now();
+        p.parse().execute();
+        secs = std::chrono::duration<double>(Clock::now() - start).count();
+        result = servo::Expression::toString(p.findVariable("r")->value).str();
+    }).join();
+    return secs;
+}
+
+int main() {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / ("servo-modules-" + std::to_string(getpid()));
+    fs::create_directories(dir);
+    for (int i = 0; i < modules; ++i) writeModule(dir.string(), i);
+    auto cwd = fs::current_path();
+    fs::current_path(dir);
+
+    unsigned pool = std::max(4u, std::thread::hardware_concurrency());
+    std::string serial_result, parallel_result, lazy_result;
+    double serial = run(1, false, serial_result);
+    double parallel = run(pool, false, parallel_result);
+    double lazy = run(1, true, lazy_result);
+
+    fs::current_path(cwd);
+    fs::remove_all(dir);
+    std::cout << modules << " modules: serial " << serial << " s, " << pool << " threads " << parallel << " s ("
+              << serial / parallel << "x, " << std::thread::hardware_concurrency() << " CPUs), lazy " << lazy << " s ("
+              << serial / lazy << "x)" << std::endl;
+    if (serial_result != parallel_result || serial_result != lazy_result) {
+        std::cout << "  MISMATCH: " << serial_result << " vs " << parallel_result << " vs " << lazy_result << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Cost of calling a native builtin through a hand-written std::function
+// wrapper versus the thunk generated by servo::bind, for a string function
+// and an integer function.
+#include "servo/internal/public/binding.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static std::string shout(std::string s) { return s + "!"; }
+static long long add(long long a, long long b) { return a + b; }
+
+static double time(servo::Variable& fn, const std::vector<std::any>& args, std::string& out) {
+    const int iterations = 1000000;
+    std::any result;
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) fn.call(servo::Args(args), result);
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    out = servo::Expression::toString(result).str();
+    return secs * 1e9 / iterations;
+}
+
+int main() {
+    // The style of the builtins before servo::bind.
+    auto shout_by_hand = std::make_shared<servo::Variable>("shout",
+        servo::Callable([](servo::Args args, std::any& result) {
+            std::string s;
+            if (!args.empty()) {
+                if (args[0].type() == typeid(servo::String)) s = std::any_cast<const servo::String&>(args[0]).str();
+                else if (args[0].type() == typeid(std::string)) s = std::any_cast<const std::string&>(args[0]);
+            }
+            result = servo::String(shout(s));
+        }),
+        "func", std::map<servo::Symbol, std::shared_ptr<servo::Variable>>{}, nullptr);
+    auto add_by_hand = std::make_shared<servo::Variable>("add",
+        servo::Callable([](servo::Args args, std::any& result) {
+            long long a = std::stoll(servo::Expression::toString(args[0]).str());
+            long long b = std::stoll(servo::Expression::toString(args[1]).str());
+            result = servo::String(std::to_string(add(a, b)));
+        }),
+        "func", std::map<servo::Symbol, std::shared_ptr<servo::Variable>>{}, nullptr);
+
+    struct Case {
+        const char* name;
+        std::shared_ptr<servo::Variable> by_hand, bound;
+        std::vector<std::any> args;
+    } cases[] = {
+        {"shout(s)", shout_by_hand, servo::bind<&shout>("shout"), {servo::String(std::string("hello"))}},
+        {"add(a, b)", add_by_hand, servo::bind<&add>("add"), {servo::String(std::string("40")), servo::String(std::string("2"))}},
+    };
+    for (auto& c : cases) {
+        std::string expected, actual;
+        double by_hand = time(*c.by_hand, c.args, expected);
+        double bound = time(*c.bound, c.args, actual);
+        std::cout << c.name << ": std::function " << by_hand << " ns/call, servo::bind " << bound << " ns/call" << std::endl;
+        if (expected != actual) {
+            std::cout << "  MISMATCH: " << expected << " vs " << actual << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+// Emits lines from a script with print and with system("echo ..."), with
+// stdout redirected to /dev/null, and reports lines per second.
+#include "servo/internal/private/parser.hpp"
+#include <chrono>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double run(const std::string& body, int lines) {
+    std::string src = "for i in range(" + std::to_string(lines) + ") {\n    " + body + "\n}\nflush()\n";
+    servo::Parser p(servo::File("virtual", src));
+    int saved = dup(1);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+    auto start = Clock::now();
+    p.parse().execute();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    dup2(saved, 1);
+    close(null);
+    close(saved);
+    return lines / secs;
+}
+
+int main() {
+    double native = run("print(\"log line\", i)", 1000000);
+    double shell = run("system(\"echo log line \" + i)", 1000);
+    std::cout << "print: " << native << " lines/s, system(echo): " << shell << " lines/s ("
+              << native / shell << "x)" << std::endl;
+    return 0;
+}
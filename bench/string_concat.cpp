@@ -0,0 +1,56 @@
+// Builds a ~100 MB string by repeated concatenation, once through servo::String
+// directly and once through the interpreter, and compares against the old
+// copy-per-append behaviour on a smaller size (it is quadratic).
+#include "servo/internal/private/parser.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void report(const std::string& label, size_t bytes, double secs) {
+    std::cout << label << ": " << bytes / (1024 * 1024) << " MB in " << secs << " s ("
+              << (bytes / (1024.0 * 1024.0)) / secs << " MB/s)" << std::endl;
+}
+
+int main() {
+    const std::string chunk(100, 'x');
+    const size_t target = 100 * 1024 * 1024;
+
+    // 1. s = s + chunk on the same value until it reaches 100 MB.
+    {
+        auto start = Clock::now();
+        servo::String s;
+        while (s.size() < target) s = s + chunk;
+        report("String builder, 100 B appends", s.size(), seconds_since(start));
+    }
+
+    // 2. Copy-per-append (previous representation) for reference, 1 MB only.
+    {
+        auto start = Clock::now();
+        std::string s;
+        while (s.size() < 1024 * 1024) {
+            std::string next = s + chunk;
+            s = next;
+        }
+        report("copy per append, 100 B appends", s.size(), seconds_since(start));
+    }
+
+    // 3. Through the interpreter: 10k appends then doublings up to 128 MB.
+    {
+        std::string src = "s=\"\"\n";
+        for (int i = 0; i < 10000; ++i) src += "s=s+\"" + chunk + "\"\n";
+        for (int i = 0; i < 7; ++i) src += "s=s+s\n";
+
+        auto start = Clock::now();
+        servo::Parser p(servo::File("virtual", src));
+        p.parse().execute();
+        auto s = std::any_cast<servo::String>(p.findVariable("s")->value);
+        report("interpreter, s=s+x then s=s+s", s.size(), seconds_since(start));
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Throughput of the system_string kernels on a large input at every level
+// the CPU supports, checked against the scalar results.
+#include "servo/internal/private/strings.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+using servo::Strings;
+
+static std::string makeText(size_t size) {
+    // Lowercase words of 1-10 letters, with a newline every ~80 bytes.
+    std::mt19937 rng(42);
+    std::string text;
+    text.reserve(size + 16);
+    size_t line = 0;
+    while (text.size() < size) {
+        size_t word = 1 + rng() % 10;
+        for (size_t i = 0; i < word; ++i) text += static_cast<char>('a' + rng() % 26);
+        line += word + 1;
+        if (line > 80) {
+            text += '\n';
+            line = 0;
+        } else {
+            text += ' ';
+        }
+    }
+    text.resize(size);
+    return text;
+}
+
+static double gbps(size_t bytes, const std::function<size_t()>& fn, size_t& check) {
+    fn(); // warm up
+    int rounds = 5;
+    auto start = Clock::now();
+    for (int i = 0; i < rounds; ++i) check = fn();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    return bytes * rounds / secs / 1e9;
+}
+
+int main() {
+    const size_t size = 64 << 20;
+    std::string text = makeText(size);
+    std::string needle = "zq#x"; // only at the end: find scans the whole input
+    text.replace(size - 100, needle.size(), needle);
+
+    struct Case {
+        const char* name;
+        std::function<size_t()> fn;
+    } cases[] = {
+        {"find", [&] { return Strings::find(text, needle); }},
+        {"count '\\n'", [&] { return Strings::count(text, "\n"); }},
+        {"count \"th\"", [&] { return Strings::count(text, "th"); }},
+        {"split '\\n'", [&] { return Strings::split(text, "\n").size(); }},
+        {"replace", [&] { return Strings::replace(text, "zz", "ZZZ").size(); }},
+        {"upper", [&] { return Strings::upper(text).size(); }},
+    };
+
+    for (auto& c : cases) {
+        size_t expected = 0;
+        std::cout << c.name << ":";
+        for (auto level : {Strings::Level::Scalar, Strings::Level::SSE2, Strings::Level::AVX2}) {
+            if (level > Strings::supported()) continue;
+            Strings::setLevel(level);
+            size_t check = 0;
+            double rate = gbps(size, c.fn, check);
+            if (level == Strings::Level::Scalar) expected = check;
+            std::cout << "  " << Strings::name(level) << " " << rate << " GB/s";
+            if (check != expected) {
+                std::cout << std::endl << "MISMATCH at " << Strings::name(level) << ": " << check << " vs " << expected << std::endl;
+                return 1;
+            }
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
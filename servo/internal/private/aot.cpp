@@ -0,0 +1,142 @@
+#include "aot.hpp"
+#include "parser.hpp"
+#include "../public/safe.hpp"
+#include <charconv>
+#include <stdexcept>
+
+namespace servo {
+
+namespace {
+
+std::vector<std::string>& scriptArgs() {
+    static std::vector<std::string> args;
+    return args;
+}
+
+}
+
+void Aot::init(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) scriptArgs().push_back(argv[i]);
+}
+
+int Aot::run(void (*script)()) {
+    int status = 0;
+    try {
+        NativeStack::run([script]() { Safe::call(script, "parsed_execution"); });
+    } catch (const std::exception&) {
+        // Safe::call has already reported the error
+        status = 1;
+    }
+    Output::flushAll();
+    return status;
+}
+
+std::shared_ptr<Variable> Aot::builtin(const char* path) {
+    std::string_view name(path);
+    size_t dot = name.find('.');
+    auto& table = Parser::builtins();
+    auto it = table.find(Symbol(std::string(name.substr(0, dot))));
+    if (it == table.end()) return nullptr;
+    std::shared_ptr<Variable> current = it->second;
+    while (dot != std::string_view::npos) {
+        size_t next = name.find('.', dot + 1);
+        auto child = current->children.find(Symbol(std::string(name.substr(dot + 1, next == std::string_view::npos ? next : next - dot - 1))));
+        if (child == current->children.end()) return nullptr;
+        current = child->second;
+        dot = next;
+    }
+    return current;
+}
+
+std::any Aot::arg(const char* key) {
+    auto& args = scriptArgs();
+    std::string_view k(key);
+    if (k == "count") return String(std::to_string(args.size()));
+    size_t i;
+    auto [end, ec] = std::from_chars(k.data(), k.data() + k.size(), i);
+    if (ec == std::errc() && end == k.data() + k.size() && i < args.size()) return String(args[i]);
+    return String("args." + std::string(k)); // unbound: its own text, as in the interpreter
+}
+
+void Aot::missing(const char* name) {
+    throw std::runtime_error("variable '" + std::string(name) + "' not found");
+}
+
+void Aot::tooDeep(const char* name) {
+    throw std::runtime_error("maximum call depth exceeded in '" + std::string(name) + "' (native stack exhausted)");
+}
+
+std::any Aot::map(std::initializer_list<std::any> keys_and_values) {
+    Map map;
+    for (auto it = keys_and_values.begin(); it != keys_and_values.end() && it + 1 != keys_and_values.end(); it += 2) {
+        map.set(Expression::mapKey(*it), *(it + 1));
+    }
+    return map;
+}
+
+Aot::Range::Range(std::initializer_list<std::any> given) {
+    long long bounds[3] = {0, 0, 1}; // start, stop, step
+    size_t i = 0;
+    for (auto& v : given) {
+        String text = Expression::toString(v);
+        auto view = text.view();
+        long long value;
+        auto [end, ec] = std::from_chars(view.data(), view.data() + view.size(), value);
+        if (ec != std::errc() || end != view.data() + view.size()) {
+            throw std::runtime_error("range() expects integers, got '" + text.str() + "'");
+        }
+        bounds[given.size() == 1 ? 1 : i] = value;
+        i++;
+    }
+    this->i = bounds[0];
+    stop = bounds[1];
+    step = bounds[2];
+    if (step == 0) throw std::runtime_error("range() step must not be zero");
+}
+
+bool Aot::Range::next(std::any& out) {
+    if (step > 0 ? i >= stop : i <= stop) return false;
+    out = String(std::to_string(i));
+    i += step;
+    return true;
+}
+
+Aot::Each::Each(std::any value) : iterable(std::move(value)) {
+    list = std::any_cast<List>(&iterable);
+    auto* map = std::any_cast<Map>(&iterable);
+    if (!list && !map) {
+        throw std::runtime_error("for expects range(), lines(), a list or a map, got '" + Expression::toString(iterable).str() + "'");
+    }
+    if (map) keys = map->keys();
+}
+
+bool Aot::Each::next(std::any& out) {
+    // As in the interpreter: lists by live index, maps over a key snapshot.
+    if (list) {
+        if (i >= list->size()) return false;
+        out = list->items()[i++];
+    } else {
+        if (i >= keys.size()) return false;
+        out = keys[i++];
+    }
+    return true;
+}
+
+Aot::Lines::Lines(const std::any& source) {
+    std::string path = Expression::toString(source).str();
+    if (path == "-" || path.empty()) {
+        reader = &LineReader::standardInput(); // shared with input(): locked per line
+    } else {
+        file = LineReader::open(path);
+        reader = file.get();
+    }
+}
+
+bool Aot::Lines::next(std::any& out) {
+    std::string line;
+    if (!reader->nextLocked(line)) return false;
+    out = String(std::move(line));
+    return true;
+}
+
+}
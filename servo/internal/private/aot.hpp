@@ -0,0 +1,80 @@
+#ifndef SERVO_INTERNAL_PRIVATE_AOT_HPP
+#define SERVO_INTERNAL_PRIVATE_AOT_HPP
+
+#include <any>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../public/collection.hpp"
+#include "../public/expression.hpp"
+#include "../public/linereader.hpp"
+#include "../public/variable.hpp"
+#include "stack.hpp"
+
+namespace servo {
+
+// Runtime support for programs produced by `servocomp --emit-cpp` (see
+// CppEmitter). Values and operators are the interpreter's own, so a
+// compiled script prints exactly what the interpreted one does.
+class Aot {
+public:
+    static void init(int argc, char** argv); // script arguments: args.count, args.0, ...
+    // Runs the script on the interpreter's native stack, reporting errors
+    // the same way; returns the exit status.
+    static int run(void (*script)());
+
+    // Builtin by name or dotted path ("print", "system_string.upper").
+    static std::shared_ptr<Variable> builtin(const char* path);
+    static std::any arg(const char* key);
+    [[noreturn]] static void missing(const char* name); // call of an unknown name
+    static void enter(const char* name) {
+        if (NativeStack::exhausted()) tooDeep(name);
+    }
+
+    // Braced arguments, so they are evaluated left to right.
+    static std::any call(Variable& fn, std::initializer_list<std::any> args) {
+        std::any result;
+        fn.call(Args(args.begin(), args.size()), result);
+        return result;
+    }
+    static std::any map(std::initializer_list<std::any> keys_and_values);
+
+    // Loop sources of `for`: next() stores the next value, false at the end.
+    class Range {
+    public:
+        explicit Range(std::initializer_list<std::any> bounds);
+        bool next(std::any& out);
+
+    private:
+        long long i, stop, step;
+    };
+    class Each {
+    public:
+        explicit Each(std::any iterable);
+        bool next(std::any& out);
+
+    private:
+        std::any iterable;
+        const List* list = nullptr;
+        std::vector<String> keys;
+        size_t i = 0;
+    };
+    class Lines {
+    public:
+        explicit Lines(const std::any& source);
+        bool next(std::any& out);
+
+    private:
+        std::unique_ptr<LineReader> file;
+        LineReader* reader;
+    };
+
+private:
+    [[noreturn]] static void tooDeep(const char* name);
+};
+
+}
+
+#endif
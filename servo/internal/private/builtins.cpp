@@ -1,4 +1,5 @@
 #include "builtins.hpp"
+#include "../public/file.hpp"
 #include <cstdio>
 #include <iostream>
 #include <stdexcept>
@@ -10,6 +11,7 @@ namespace servo {
 void Builtins::system(std::string args) {
     Safe::call([args]() {
         // Simple system call, not capturing output properly for print unless we simulate check=True
+        Output::flushAll(); // the child writes to the same descriptors
         int ret = std::system(args.c_str());
         if (ret != 0) {
             throw std::runtime_error("Command failed with return code " + std::to_string(ret));
@@ -21,6 +23,7 @@ std::string Builtins::systemreturn(std::string args) {
     return Safe::call([args]() -> std::string {
         std::array<char, 128> buffer;
         std::string result;
+        Output::flushAll();
         std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(args.c_str(), "r"), pclose);
         if (!pipe) {
             throw std::runtime_error("popen() failed!");
@@ -38,4 +41,37 @@ void Builtins::if_(bool condition, std::function<void()> true_branch) {
     }, "servo.internal.private.builtins");
 }
 
+std::string Builtins::bc(const char* function, const std::string& x) {
+    if (x.empty()) return "0";
+    std::string res = systemreturn("echo \"" + std::string(function) + "(" + x + ")\" | bc -l");
+    if (!res.empty() && res.back() == '\n') res.pop_back();
+    return res;
+}
+
+std::string Builtins::sin(std::string x) { return bc("s", x); }
+std::string Builtins::cos(std::string x) { return bc("c", x); }
+std::string Builtins::sqrt(std::string x) { return bc("sqrt", x); }
+
+// File reports its own errors through Safe::call.
+std::string Builtins::fileRead(std::string path, uint64_t offset, uint64_t length) {
+    return File(path, true).readRange(offset, length);
+}
+
+void Builtins::fileWrite(std::string path, std::string content, std::string mode) {
+    File(path, true).write(std::move(content), mode);
+}
+
+void Builtins::fileWriteAt(std::string path, uint64_t offset, std::string content) {
+    File(path, true).writeAt(offset, content);
+}
+
+std::string Builtins::fileList(std::string path) {
+    std::string out;
+    for (auto& name : File(path, true).list()) {
+        out += name;
+        out += '\n';
+    }
+    return out;
+}
+
 }
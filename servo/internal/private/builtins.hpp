@@ -1,6 +1,7 @@
 #ifndef SERVO_INTERNAL_PRIVATE_BUILTINS_HPP
 #define SERVO_INTERNAL_PRIVATE_BUILTINS_HPP
 
+#include <cstdint>
 #include <string>
 #include <functional>
 #include "../public/safe.hpp"
@@ -12,6 +13,20 @@ public:
     static void system(std::string args);
     static std::string systemreturn(std::string args);
     static void if_(bool condition, std::function<void()> true_branch);
+
+    // system_math, through bc -l; "0" without an argument.
+    static std::string sin(std::string x);
+    static std::string cos(std::string x);
+    static std::string sqrt(std::string x);
+
+    // system_file: native file access through servo::File, no process spawn.
+    static std::string fileRead(std::string path, uint64_t offset = 0, uint64_t length = UINT64_MAX);
+    static void fileWrite(std::string path, std::string content, std::string mode = "w");
+    static void fileWriteAt(std::string path, uint64_t offset, std::string content);
+    static std::string fileList(std::string path); // one name per line, like ls
+
+private:
+    static std::string bc(const char* function, const std::string& x);
 };
 
 }
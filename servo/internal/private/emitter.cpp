@@ -0,0 +1,403 @@
+#include "emitter.hpp"
+#include "aot.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace servo {
+
+namespace {
+
+using Statements = std::vector<std::shared_ptr<Statement>>;
+
+struct Function {
+    std::string cpp;
+    std::vector<Symbol> params;
+    const Statements* body = nullptr; // null: empty body, any arguments
+    Parser* parser = nullptr;
+    bool takes_block = false;
+};
+
+// C++ spelling of a servo name: letters, digits and '_' are kept.
+std::string identifier(const char* prefix, const std::string& name) {
+    std::string out = prefix;
+    for (unsigned char c : name) {
+        if (isalnum(c) || c == '_') {
+            out += static_cast<char>(c);
+        } else {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "_x%02X", c);
+            out += buf;
+        }
+    }
+    return out;
+}
+
+std::string quote(const std::string& text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7F) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\%03o", c);
+            out += buf;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+const char* opEnum(Expression::Op op) {
+    switch (op) {
+        case Expression::Op::Add: return "Add";
+        case Expression::Op::Sub: return "Sub";
+        case Expression::Op::Mul: return "Mul";
+        case Expression::Op::Div: return "Div";
+        case Expression::Op::Mod: return "Mod";
+        case Expression::Op::Pow: return "Pow";
+        case Expression::Op::Eq: return "Eq";
+        case Expression::Op::Ne: return "Ne";
+        case Expression::Op::Lt: return "Lt";
+        case Expression::Op::Gt: return "Gt";
+        case Expression::Op::Le: return "Le";
+        case Expression::Op::Ge: return "Ge";
+        case Expression::Op::And: return "And";
+        case Expression::Op::Or: return "Or";
+        case Expression::Op::Neg: return "Neg";
+        case Expression::Op::Not: return "Not";
+        case Expression::Op::In: return "In";
+        case Expression::Op::None: break;
+    }
+    return "None";
+}
+
+[[noreturn]] void unsupported(const std::string& what) {
+    throw std::runtime_error("--emit-cpp does not support " + what);
+}
+
+void collectAssigned(const Statements& statements, std::set<Symbol>& out) {
+    for (auto& stmt : statements) {
+        if (stmt->kind == Statement::Kind::Assign || stmt->kind == Statement::Kind::For) out.insert(stmt->name);
+        collectAssigned(stmt->body, out);
+    }
+}
+
+// Only calls can have side effects whose order matters.
+bool effects(const Expression& e) {
+    if (e.kind == Expression::Kind::Call) return true;
+    for (auto& child : e.children) {
+        if (effects(*child)) return true;
+    }
+    return false;
+}
+
+class Emitter {
+public:
+    explicit Emitter(Parser& program) : program(program) {}
+
+    std::string run(const std::string& source_name) {
+        const auto& defaults = Parser::builtins();
+        for (auto& [name, var] : program.pool) {
+            auto d = defaults.find(name);
+            if ((d != defaults.end() && d->second == var) || var->value_type != "func") continue;
+            Function f;
+            f.cpp = identifier("f_", name.str());
+            f.takes_block = var->children.count("__block_arg_index") > 0;
+            auto jit = var->children.find("__jit");
+            if (jit != var->children.end()) {
+                auto& state = std::any_cast<const std::shared_ptr<JitFunction>&>(jit->second->value);
+                f.params = state->params;
+                f.body = &state->body->statements;
+                f.parser = state->body;
+            }
+            functions[name] = f;
+        }
+        collectAssigned(program.statements, globals);
+
+        std::ostringstream bodies;
+        for (auto& [name, f] : functions) {
+            if (f.takes_block) continue; // calls to it are rejected
+            function(bodies, name, f);
+        }
+        bodies << "void script() {\n";
+        Scope top{nullptr, nullptr, nullptr};
+        block(bodies, program.statements, top, 1);
+        bodies << "}\n";
+
+        std::ostringstream state;
+        for (auto& name : globals) {
+            state << "std::any " << identifier("g_", name.str()) << " = " << literal(name.str()) << ";\n";
+        }
+
+        std::ostringstream out;
+        out << "// Generated by servocomp --emit-cpp from " << source_name << "; do not edit.\n"
+            << "#include \"servo/internal/private/aot.hpp\"\n\n"
+            << "namespace {\n\n";
+        for (auto& def : constants) out << def << "\n";
+        if (!constants.empty()) out << "\n";
+        if (!globals.empty()) out << state.str() << "\n";
+        for (auto& [name, f] : functions) {
+            if (!f.takes_block) out << "std::any " << f.cpp << "(" << paramList(f) << ");\n";
+        }
+        out << "\n" << bodies.str() << "\n}\n\n"
+            << "int main(int argc, char** argv) {\n"
+            << "    servo::Aot::init(argc, argv);\n"
+            << "    return servo::Aot::run(script);\n"
+            << "}\n";
+        return out.str();
+    }
+
+private:
+    struct Scope {
+        const std::set<Symbol>* locals; // null at top level
+        const Function* function;
+        Parser* parser;
+    };
+
+    Parser& program;
+    std::map<Symbol, Function> functions;
+    std::set<Symbol> globals;
+    std::vector<std::string> constants;
+    std::map<std::string, std::string> literals;  // text -> constant
+    std::map<std::string, std::string> builtins;  // path -> constant
+    int temps = 0;
+
+    std::string temp() { return "t" + std::to_string(temps++) + "_"; }
+
+    std::string literal(const std::string& text) {
+        auto& name = literals[text];
+        if (name.empty()) {
+            name = "k" + std::to_string(literals.size() - 1);
+            constants.push_back("const std::any " + name + " = servo::String(std::string(" + quote(text) + ", " + std::to_string(text.size()) + "));");
+        }
+        return name;
+    }
+
+    // "" when path names no builtin.
+    std::string builtin(const std::string& path) {
+        auto it = builtins.find(path);
+        if (it != builtins.end()) return it->second;
+        if (!Aot::builtin(path.c_str())) return "";
+        std::string name = "b" + std::to_string(builtins.size());
+        constants.push_back("const std::shared_ptr<servo::Variable> " + name + " = servo::Aot::builtin(" + quote(path) + ");");
+        return builtins[path] = name;
+    }
+
+    std::string paramList(const Function& f) {
+        std::string out;
+        for (size_t i = 0; i < f.params.size(); ++i) out += (i ? ", std::any " : "std::any ") + identifier("l_", f.params[i].str());
+        return out;
+    }
+
+    bool local(const Scope& scope, Symbol name) const { return scope.locals && scope.locals->count(name); }
+
+    std::string variable(const Scope& scope, Symbol name) {
+        if (local(scope, name)) return identifier("l_", name.str());
+        if (globals.count(name)) return identifier("g_", name.str());
+        return "";
+    }
+
+    std::string read(const Expression& e, const Scope& scope) {
+        const std::string& name = e.name.str();
+        if (name.find('.') != std::string::npos) {
+            if (name.rfind("args.", 0) == 0) return "servo::Aot::arg(" + quote(name.substr(5)) + ")";
+            std::string b = builtin(name);
+            return b.empty() ? literal(name) : b + "->value";
+        }
+        std::string v = variable(scope, e.name);
+        if (!v.empty()) return v;
+        if (functions.count(e.name)) unsupported("functions used as values ('" + name + "')");
+        std::string b = builtin(name);
+        return b.empty() ? literal(name) : b + "->value"; // unbound: its own text
+    }
+
+    std::string call(const Expression& e, const Scope& scope) {
+        const std::string& name = e.name.str();
+        if (scope.parser) {
+            auto it = scope.parser->pool.find(e.name);
+            auto d = Parser::builtins().find(e.name);
+            if (it != scope.parser->pool.end() && it->second->value_type == "func"
+                && (d == Parser::builtins().end() || d->second != it->second)) {
+                unsupported("functions defined inside functions ('" + name + "')");
+            }
+        }
+
+        auto f = functions.find(e.name);
+        if (f != functions.end()) {
+            if (f->second.takes_block) unsupported("block arguments ('" + name + "')");
+            size_t params = f->second.params.size();
+            size_t effectful = 0;
+            for (auto& arg : e.children) effectful += effects(*arg);
+            if (effectful <= 1 && e.children.size() <= params) {
+                std::string out = f->second.cpp + "(";
+                for (size_t i = 0; i < params; ++i) {
+                    if (i) out += ", ";
+                    out += i < e.children.size() ? expr(*e.children[i], scope) : "std::any(servo::String())";
+                }
+                return out + ")";
+            }
+            // Arguments are evaluated left to right, extra ones only for their effects.
+            std::string out = "[&] {";
+            std::vector<std::string> names;
+            for (auto& arg : e.children) {
+                names.push_back(temp());
+                out += " std::any " + names.back() + " = " + expr(*arg, scope) + ";";
+            }
+            out += " return " + f->second.cpp + "(";
+            for (size_t i = 0; i < params; ++i) {
+                if (i) out += ", ";
+                out += i < names.size() ? "std::move(" + names[i] + ")" : "std::any(servo::String())";
+            }
+            return out + "); }()";
+        }
+
+        std::string b = builtin(name);
+        if (b.empty()) return "(servo::Aot::missing(" + quote(name) + "), std::any())";
+        std::string out = "servo::Aot::call(*" + b + ", {";
+        for (size_t i = 0; i < e.children.size(); ++i) out += (i ? ", " : "") + expr(*e.children[i], scope);
+        return out + "})";
+    }
+
+    // head + "a, b)" with a evaluated first.
+    std::string ordered(const std::string& head, const Expression& a, const Expression& b, const Scope& scope) {
+        if (!effects(a) || !effects(b)) return head + expr(a, scope) + ", " + expr(b, scope) + ")";
+        std::string t = temp();
+        return "[&] { std::any " + t + " = " + expr(a, scope) + "; return " + head + t + ", " + expr(b, scope) + "); }()";
+    }
+
+    std::string expr(const Expression& e, const Scope& scope) {
+        switch (e.kind) {
+            case Expression::Kind::Literal:
+                return literal(e.literal.str());
+            case Expression::Kind::Variable:
+                return read(e, scope);
+            case Expression::Kind::Call:
+                return call(e, scope);
+            case Expression::Kind::Unary:
+                return std::string("servo::Expression::unary(servo::Expression::Op::") + opEnum(e.op) + ", " + expr(*e.children[0], scope) + ")";
+            case Expression::Kind::Binary:
+                if (e.op == Expression::Op::And || e.op == Expression::Op::Or) {
+                    return std::string("servo::Expression::boolean(servo::Expression::truthy(") + expr(*e.children[0], scope)
+                        + (e.op == Expression::Op::And ? ") && " : ") || ") + "servo::Expression::truthy(" + expr(*e.children[1], scope) + "))";
+                }
+                return ordered(std::string("servo::Expression::binary(servo::Expression::Op::") + opEnum(e.op) + ", ", *e.children[0], *e.children[1], scope);
+            case Expression::Kind::List: {
+                std::string out = "std::any(servo::List(std::vector<std::any>{";
+                for (size_t i = 0; i < e.children.size(); ++i) out += (i ? ", " : "") + expr(*e.children[i], scope);
+                return out + "}))";
+            }
+            case Expression::Kind::Map: {
+                std::string out = "servo::Aot::map({";
+                for (size_t i = 0; i < e.children.size(); ++i) out += (i ? ", " : "") + expr(*e.children[i], scope);
+                return out + "})";
+            }
+            case Expression::Kind::Index:
+                return ordered("servo::Expression::index(", *e.children[0], *e.children[1], scope);
+        }
+        unsupported("this expression");
+    }
+
+    void line(std::ostream& out, int depth, const std::string& text) {
+        out << std::string(depth * 4, ' ') << text << "\n";
+    }
+
+    void block(std::ostream& out, const Statements& statements, const Scope& scope, int depth) {
+        for (auto& stmt : statements) statement(out, *stmt, scope, depth);
+    }
+
+    void statement(std::ostream& out, const Statement& stmt, const Scope& scope, int depth) {
+        switch (stmt.kind) {
+            case Statement::Kind::Expression:
+                if (stmt.block) unsupported("block arguments ('" + stmt.expression->name.str() + "')");
+                line(out, depth, "static_cast<void>(" + expr(*stmt.expression, scope) + ");");
+                return;
+            case Statement::Kind::Assign:
+                line(out, depth, variable(scope, stmt.name) + " = " + expr(*stmt.expression, scope) + ";");
+                return;
+            case Statement::Kind::SetIndex: {
+                // Value first, then container and key, as in the interpreter.
+                std::string v = temp(), c = temp();
+                line(out, depth, "{");
+                line(out, depth + 1, "std::any " + v + " = " + expr(*stmt.expression, scope) + ";");
+                line(out, depth + 1, "std::any " + c + " = " + expr(*stmt.target->children[0], scope) + ";");
+                line(out, depth + 1, "servo::Expression::assignIndex(" + c + ", " + expr(*stmt.target->children[1], scope) + ", std::move(" + v + "));");
+                line(out, depth, "}");
+                return;
+            }
+            case Statement::Kind::Return:
+                if (scope.function) {
+                    line(out, depth, stmt.expression ? "return " + expr(*stmt.expression, scope) + ";" : "return std::any();");
+                } else {
+                    if (stmt.expression) line(out, depth, "static_cast<void>(" + expr(*stmt.expression, scope) + ");");
+                    line(out, depth, "return;");
+                }
+                return;
+            case Statement::Kind::Import:
+                unsupported("imports ('" + stmt.name.str() + "')");
+            case Statement::Kind::While:
+                line(out, depth, "while (servo::Expression::truthy(" + expr(*stmt.expression, scope) + ")) {");
+                block(out, stmt.body, scope, depth + 1);
+                line(out, depth, "}");
+                return;
+            case Statement::Kind::For: {
+                const Expression& source = *stmt.expression;
+                std::string it = temp(), var = variable(scope, stmt.name);
+                std::string args;
+                for (size_t i = 0; i < source.children.size(); ++i) args += (i ? ", " : "") + expr(*source.children[i], scope);
+                std::string head;
+                if (source.kind == Expression::Kind::Call && source.name == Symbol("lines")) {
+                    head = "servo::Aot::Lines " + it + "(" + (source.children.empty() ? literal("-") : args) + ")";
+                } else if (source.kind == Expression::Kind::Call && source.name == Symbol("range")) {
+                    head = "servo::Aot::Range " + it + "({" + args + "})";
+                } else {
+                    head = "servo::Aot::Each " + it + "(" + expr(source, scope) + ")";
+                }
+                line(out, depth, "for (" + head + "; " + it + ".next(" + var + ");) {");
+                block(out, stmt.body, scope, depth + 1);
+                line(out, depth, "}");
+                return;
+            }
+        }
+    }
+
+    void function(std::ostream& out, Symbol name, const Function& f) {
+        out << "std::any " << f.cpp << "(" << paramList(f) << ") {\n";
+        if (f.body) {
+            line(out, 1, "servo::Aot::enter(" + quote(name.str()) + ");");
+            std::set<Symbol> locals(f.params.begin(), f.params.end());
+            std::set<Symbol> assigned;
+            collectAssigned(*f.body, assigned);
+            Scope outer{nullptr, nullptr, nullptr};
+            for (auto& local : assigned) {
+                if (locals.insert(local).second) {
+                    // Until assigned, the name still reads the global (or its own text).
+                    std::string global = variable(outer, local);
+                    line(out, 1, "std::any " + identifier("l_", local.str()) + " = " + (global.empty() ? literal(local.str()) : global) + ";");
+                }
+            }
+            Scope scope{&locals, &f, f.parser};
+            block(out, *f.body, scope, 1);
+            if (!f.body->empty() && f.body->back()->kind == Statement::Kind::Return) {
+                out << "}\n\n";
+                return;
+            }
+        }
+        line(out, 1, "return std::any();");
+        out << "}\n\n";
+    }
+};
+
+}
+
+std::string CppEmitter::emit(Parser& program, const std::string& source_name) {
+    return Emitter(program).run(source_name);
+}
+
+}
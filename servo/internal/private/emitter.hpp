@@ -0,0 +1,26 @@
+#ifndef SERVO_INTERNAL_PRIVATE_EMITTER_HPP
+#define SERVO_INTERNAL_PRIVATE_EMITTER_HPP
+
+#include <string>
+
+namespace servo {
+
+class Parser;
+
+// `servocomp --emit-cpp`: translates a parsed (not executed) program into
+// one C++ translation unit built against the servo library (see Aot and
+// the Makefile's %.aot rule). User functions become C++ functions taking
+// and returning std::any, their locals C++ locals, globals file-scope
+// variables; builtins are called directly through their Variables.
+//
+// Supported: everything but imports, block arguments, functions defined
+// inside functions and module member access other than builtins and
+// args.*; those throw std::runtime_error naming the construct.
+class CppEmitter {
+public:
+    static std::string emit(Parser& program, const std::string& source_name);
+};
+
+}
+
+#endif
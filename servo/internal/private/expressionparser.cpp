@@ -0,0 +1,218 @@
+#include "expressionparser.hpp"
+#include <cctype>
+#include <stdexcept>
+
+namespace servo {
+
+ExpressionParser::ExpressionParser(std::string source) : source(std::move(source)) {
+    advance();
+}
+
+void ExpressionParser::fail(const std::string& message) const {
+    throw std::runtime_error(message + " in expression '" + source + "'");
+}
+
+void ExpressionParser::advance() {
+    while (pos < source.size() && isspace(static_cast<unsigned char>(source[pos]))) pos++;
+    current = Token();
+    // '#' starts a trailing comment, as at statement level.
+    if (pos >= source.size() || source[pos] == '#') {
+        pos = source.size();
+        return;
+    }
+
+    char c = source[pos];
+    size_t start = pos;
+    if (isdigit(static_cast<unsigned char>(c)) || (c == '.' && pos + 1 < source.size() && isdigit(static_cast<unsigned char>(source[pos + 1])))) {
+        while (pos < source.size() && (isdigit(static_cast<unsigned char>(source[pos])) || source[pos] == '.')) pos++;
+        // Exponent, as in "1.5e+20": only when digits follow.
+        size_t e = pos + 1;
+        if (e < source.size() && (source[e] == '+' || source[e] == '-')) e++;
+        if (pos < source.size() && (source[pos] == 'e' || source[pos] == 'E') && e < source.size() && isdigit(static_cast<unsigned char>(source[e]))) {
+            pos = e;
+            while (pos < source.size() && isdigit(static_cast<unsigned char>(source[pos]))) pos++;
+        }
+        current.type = TokenType::Number;
+        current.text = source.substr(start, pos - start);
+    } else if (c == '"' || c == '\'') {
+        size_t end = source.find(c, pos + 1);
+        if (end == std::string::npos) fail("Unterminated string");
+        current.type = TokenType::String;
+        current.text = source.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+    } else if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+        while (pos < source.size() && (isalnum(static_cast<unsigned char>(source[pos])) || source[pos] == '_' || source[pos] == '.')) pos++;
+        current.type = TokenType::Identifier;
+        current.text = source.substr(start, pos - start);
+    } else {
+        static const char* two_char[] = {"==", "!=", "<=", ">=", "&&", "||"};
+        current.type = TokenType::Punct;
+        for (const char* op : two_char) {
+            if (source.compare(pos, 2, op) == 0) {
+                current.text = op;
+                pos += 2;
+                return;
+            }
+        }
+        if (std::string("+-*/%^<>!(),[]{}:").find(c) == std::string::npos) {
+            fail(std::string("Unexpected character '") + c + "'");
+        }
+        current.text = std::string(1, c);
+        pos++;
+    }
+}
+
+bool ExpressionParser::isPunct(const char* punct) const {
+    return current.type == TokenType::Punct && current.text == punct;
+}
+
+void ExpressionParser::expect(const std::string& punct) {
+    if (!isPunct(punct.c_str())) {
+        fail("Expected '" + punct + "' but got '" + current.text + "'");
+    }
+    advance();
+}
+
+int ExpressionParser::precedence(const std::string& op, Expression::Op& out) {
+    if (op == "||") { out = Expression::Op::Or; return 1; }
+    if (op == "&&") { out = Expression::Op::And; return 2; }
+    if (op == "==") { out = Expression::Op::Eq; return 3; }
+    if (op == "!=") { out = Expression::Op::Ne; return 3; }
+    if (op == "<") { out = Expression::Op::Lt; return 4; }
+    if (op == ">") { out = Expression::Op::Gt; return 4; }
+    if (op == "<=") { out = Expression::Op::Le; return 4; }
+    if (op == ">=") { out = Expression::Op::Ge; return 4; }
+    if (op == "in") { out = Expression::Op::In; return 4; }
+    if (op == "+") { out = Expression::Op::Add; return 5; }
+    if (op == "-") { out = Expression::Op::Sub; return 5; }
+    if (op == "*") { out = Expression::Op::Mul; return 6; }
+    if (op == "/") { out = Expression::Op::Div; return 6; }
+    if (op == "%") { out = Expression::Op::Mod; return 6; }
+    if (op == "^") { out = Expression::Op::Pow; return 7; }
+    return -1;
+}
+
+std::shared_ptr<Expression> ExpressionParser::parse() {
+    auto expr = parseExpression(1);
+    if (current.type != TokenType::End) fail("Unexpected '" + current.text + "'");
+    return expr;
+}
+
+std::vector<std::shared_ptr<Expression>> ExpressionParser::parseArguments() {
+    auto args = parseList(nullptr);
+    if (current.type != TokenType::End) fail("Unexpected '" + current.text + "'");
+    return args;
+}
+
+std::vector<std::shared_ptr<Expression>> ExpressionParser::parseList(const char* terminator) {
+    std::vector<std::shared_ptr<Expression>> items;
+    auto at_end = [&]() {
+        return terminator ? isPunct(terminator) : current.type == TokenType::End;
+    };
+    if (at_end()) return items;
+    while (true) {
+        items.push_back(parseExpression(1));
+        if (!isPunct(",")) break;
+        advance();
+    }
+    if (!at_end()) fail("Expected ',' but got '" + current.text + "'");
+    return items;
+}
+
+std::shared_ptr<Expression> ExpressionParser::parseExpression(int min_prec) {
+    auto left = parsePostfix(parsePrefix());
+    while (current.type == TokenType::Punct || (current.type == TokenType::Identifier && current.text == "in")) {
+        Expression::Op op;
+        int prec = precedence(current.text, op);
+        if (prec < min_prec) break;
+        advance();
+        // '^' is right associative, everything else left associative.
+        auto right = parseExpression(op == Expression::Op::Pow ? prec : prec + 1);
+        auto node = std::make_shared<Expression>(Expression::Kind::Binary);
+        node->op = op;
+        node->children = {left, right};
+        left = node;
+    }
+    return left;
+}
+
+std::shared_ptr<Expression> ExpressionParser::parsePostfix(std::shared_ptr<Expression> node) {
+    while (isPunct("[")) {
+        advance();
+        auto index = std::make_shared<Expression>(Expression::Kind::Index);
+        index->children = {node, parseExpression(1)};
+        expect("]");
+        node = index;
+    }
+    return node;
+}
+
+std::shared_ptr<Expression> ExpressionParser::parsePrefix() {
+    Token tok = current;
+    switch (tok.type) {
+        case TokenType::Number:
+        case TokenType::String: {
+            advance();
+            auto node = std::make_shared<Expression>(Expression::Kind::Literal);
+            node->literal = String(Symbol(tok.text));
+            return node;
+        }
+        case TokenType::Identifier: {
+            advance();
+            if (isPunct("(")) {
+                advance();
+                auto node = std::make_shared<Expression>(Expression::Kind::Call);
+                node->name = Symbol(tok.text);
+                node->children = parseList(")");
+                expect(")");
+                return node;
+            }
+            auto node = std::make_shared<Expression>(Expression::Kind::Variable);
+            node->name = Symbol(tok.text);
+            return node;
+        }
+        case TokenType::Punct: {
+            if (tok.text == "(") {
+                advance();
+                auto inner = parseExpression(1);
+                expect(")");
+                return inner;
+            }
+            if (tok.text == "[") {
+                advance();
+                auto node = std::make_shared<Expression>(Expression::Kind::List);
+                node->children = parseList("]");
+                expect("]");
+                return node;
+            }
+            if (tok.text == "{") {
+                // Map literal: children alternate key, value.
+                advance();
+                auto node = std::make_shared<Expression>(Expression::Kind::Map);
+                while (!isPunct("}")) {
+                    node->children.push_back(parseExpression(1));
+                    expect(":");
+                    node->children.push_back(parseExpression(1));
+                    if (!isPunct(",")) break;
+                    advance();
+                }
+                expect("}");
+                return node;
+            }
+            if (tok.text == "-" || tok.text == "!") {
+                advance();
+                auto node = std::make_shared<Expression>(Expression::Kind::Unary);
+                node->op = (tok.text == "-") ? Expression::Op::Neg : Expression::Op::Not;
+                // Unary binds tighter than every binary operator except '^' (-2^2 == -4).
+                node->children = {parseExpression(7)};
+                return node;
+            }
+            break;
+        }
+        case TokenType::End:
+            fail("Unexpected end");
+    }
+    fail("Unexpected '" + tok.text + "'");
+}
+
+}
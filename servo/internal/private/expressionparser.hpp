@@ -0,0 +1,49 @@
+#ifndef SERVO_INTERNAL_PRIVATE_EXPRESSIONPARSER_HPP
+#define SERVO_INTERNAL_PRIVATE_EXPRESSIONPARSER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../public/expression.hpp"
+
+namespace servo {
+
+// Precedence-climbing (Pratt) parser turning expression source into an
+// Expression tree. Lowest to highest binding:
+//   ||   &&   == !=   < > <= >= in   + -   * / %   ^ (right assoc)   unary - !
+// followed by postfix indexing a[i]. [a, b] and {k: v} build lists and maps.
+class ExpressionParser {
+public:
+    ExpressionParser(std::string source);
+
+    // Parse a single expression spanning the whole source.
+    std::shared_ptr<Expression> parse();
+    // Parse a comma separated argument list spanning the whole source.
+    std::vector<std::shared_ptr<Expression>> parseArguments();
+
+private:
+    enum class TokenType { End, Number, String, Identifier, Punct };
+    struct Token {
+        TokenType type = TokenType::End;
+        std::string text;
+    };
+
+    std::string source;
+    size_t pos = 0;
+    Token current;
+
+    void advance();
+    void expect(const std::string& punct);
+    bool isPunct(const char* punct) const;
+    [[noreturn]] void fail(const std::string& message) const;
+
+    std::shared_ptr<Expression> parseExpression(int min_prec);
+    std::shared_ptr<Expression> parsePrefix();
+    std::shared_ptr<Expression> parsePostfix(std::shared_ptr<Expression> node);
+    std::vector<std::shared_ptr<Expression>> parseList(const char* terminator);
+    static int precedence(const std::string& op, Expression::Op& out);
+};
+
+}
+
+#endif
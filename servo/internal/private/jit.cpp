@@ -0,0 +1,814 @@
+#include "jit.hpp"
+#include "parser.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sys/mman.h>
+
+namespace servo {
+
+bool Jit::enabled = false;
+uint32_t Jit::threshold = 10;
+
+namespace {
+
+// int fn(const int64_t* args, int64_t* result, int* ctx)
+// returns 0 (value in *result), 1 (no value) or 2 (bail out).
+// ctx[0] is the native call depth, ctx[1] is set when it hit max_depth.
+using NativeFn = int (*)(const int64_t*, int64_t*, int*);
+
+constexpr int32_t max_depth = 10000;
+constexpr uint32_t max_bails = 100;
+
+enum Cond : uint8_t { O = 0x0, E = 0x4, NE = 0x5, L = 0xC, GE = 0xD, LE = 0xE, G = 0xF };
+enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RSI = 6 };
+
+void* mapCode(const std::vector<uint8_t>& bytes, size_t& size) {
+    size = bytes.size();
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return nullptr;
+    std::memcpy(mem, bytes.data(), size);
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        return nullptr;
+    }
+    return mem;
+}
+
+void* bailStub() {
+    static void* stub = [] {
+        size_t size;
+        return mapCode({0xB8, 0x02, 0x00, 0x00, 0x00, 0xC3}, size); // mov eax, 2; ret
+    }();
+    return stub;
+}
+
+// Minimal x86-64 emitter for the fixed instruction set the compiler uses.
+class Assembler {
+public:
+    std::vector<uint8_t> code;
+
+    void emit(std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); }
+    void imm32(int32_t v) { for (int i = 0; i < 4; ++i) code.push_back(static_cast<uint8_t>(v >> (8 * i))); }
+    void imm64(int64_t v) { for (int i = 0; i < 8; ++i) code.push_back(static_cast<uint8_t>(v >> (8 * i))); }
+
+    int label() { labels.push_back(-1); return static_cast<int>(labels.size()) - 1; }
+    void bind(int l) { labels[l] = static_cast<int>(code.size()); }
+    void jmp(int l) { emit({0xE9}); fixup(l); }
+    void jcc(Cond c, int l) { emit({0x0F, static_cast<uint8_t>(0x80 | c)}); fixup(l); }
+    bool finish() {
+        for (auto& [pos, l] : fixups) {
+            if (labels[l] < 0) return false;
+            int32_t rel = labels[l] - (pos + 4);
+            std::memcpy(&code[pos], &rel, 4);
+        }
+        return true;
+    }
+
+    // mov reg, [rbp + disp] / mov [rbp + disp], reg
+    void load(Reg r, int32_t disp) { emit({0x48, 0x8B, static_cast<uint8_t>(0x85 | (r << 3))}); imm32(disp); }
+    void store(Reg r, int32_t disp) { emit({0x48, 0x89, static_cast<uint8_t>(0x85 | (r << 3))}); imm32(disp); }
+    void movImm(int64_t v) { emit({0x48, 0xB8}); imm64(v); }          // mov rax, imm64
+    void storeImm(int32_t disp, int32_t v) { emit({0x48, 0xC7, 0x85}); imm32(disp); imm32(v); } // mov qword [rbp+disp], imm32
+    void push() { emit({0x50}); }                                       // push rax
+    void pop(Reg r) { emit({static_cast<uint8_t>(0x58 | r)}); }        // pop reg
+    void testRax() { emit({0x48, 0x85, 0xC0}); }
+    void setcc(Cond c) { emit({0x0F, static_cast<uint8_t>(0x90 | c), 0xC0, 0x0F, 0xB6, 0xC0}); } // setcc al; movzx eax, al
+    void status(int32_t v) { emit({0xB8}); imm32(v); }                 // mov eax, imm32
+
+private:
+    std::vector<int> labels;
+    std::vector<std::pair<int, int>> fixups;
+    void fixup(int l) { fixups.push_back({static_cast<int>(code.size()), l}); imm32(0); }
+};
+
+bool canonicalInt(std::string_view text, int64_t& out) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+    if (ec != std::errc() || end != text.data() + text.size()) return false;
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), out);
+    return std::string_view(buf, res.ptr - buf) == text; // "007", "-0" print differently
+}
+
+// A float the interpreter prints back as the same text: %.15g, with a point.
+bool canonicalReal(std::string_view text, double& out) {
+    if (text.find('.') == std::string_view::npos) return false;
+    for (size_t k = 0; k < text.size(); ++k) {
+        char c = text[k];
+        if (!(c >= '0' && c <= '9') && c != '.' && !(c == '-' && k == 0)) return false;
+    }
+    out = std::strtod(std::string(text).c_str(), nullptr);
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%.15g", out);
+    return std::string_view(buf, n) == text;
+}
+
+using Type = JitFunction::Type;
+
+Type join(Type a, Type b) {
+    if (a == Type::None) return b;
+    if (b == Type::None || a == b) return a;
+    return Type::Any;
+}
+
+bool numeric(Type t) { return t == Type::Int || t == Type::Float; }
+
+// Type of a value's text, with its native form (int64 or double bits) in `bits`.
+Type valueType(std::string_view text, int64_t& bits) {
+    if (canonicalInt(text, bits)) return Type::Int;
+    double d;
+    if (!canonicalReal(text, d)) return Type::Any;
+    std::memcpy(&bits, &d, sizeof(d));
+    return Type::Float;
+}
+
+Type valueType(const std::any& value, int64_t& bits) {
+    auto* text = std::any_cast<String>(&value);
+    return text ? valueType(text->view(), bits) : Type::Any;
+}
+
+// The interpreter keeps numbers as text, so every float result is printed
+// with %.15g and read back. Apply the same rounding without the text: scale
+// to 15 integral digits, round (fma recovers the exact product for ties) and
+// scale back, both steps exact below 2^53. False when the text would not read
+// back as a float this code holds: an integer, exponent form, inf or nan.
+bool roundReal(double& d) {
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                   1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+    double m = std::fabs(d);
+    if (!(m >= 1e-4 && m < 1e15)) return false;
+    int k = 0;
+    while (k < 18) {
+        double prod = m * pow10[k];
+        if (prod > 1e14 || (prod == 1e14 && std::fma(m, pow10[k], -prod) >= 0)) break;
+        ++k;
+    }
+    double prod = m * pow10[k];
+    double q = std::nearbyint(prod);
+    if (prod - std::floor(prod) == 0.5) {
+        double err = std::fma(m, pow10[k], -prod);
+        if (err != 0) q = err > 0 ? std::ceil(prod) : std::floor(prod);
+    }
+    double r = q / pow10[k];
+    if (r >= 1e15 || r == std::trunc(r)) return false;
+    d = std::copysign(r, d);
+    return true;
+}
+
+// Float arithmetic and comparisons called from compiled code. The low byte of
+// `code` is the Op; bits 8 and 9 are set when x and y hold double bits rather
+// than int64. Returns 0 to bail out.
+int realOp(int64_t code, int64_t x, int64_t y, int64_t* out) {
+    double a, b, r;
+    if (code & 0x100) std::memcpy(&a, &x, sizeof(a)); else a = static_cast<double>(x);
+    if (code & 0x200) std::memcpy(&b, &y, sizeof(b)); else b = static_cast<double>(y);
+    switch (static_cast<Expression::Op>(code & 0xFF)) {
+        case Expression::Op::Add: r = a + b; break;
+        case Expression::Op::Sub: r = a - b; break;
+        case Expression::Op::Mul: r = a * b; break;
+        case Expression::Op::Div: if (b == 0) return 0; r = a / b; break;
+        case Expression::Op::Mod: if (b == 0) return 0; r = std::fmod(a, b); break;
+        case Expression::Op::Eq: *out = a == b; return 1;
+        case Expression::Op::Ne: *out = a != b; return 1;
+        case Expression::Op::Lt: *out = a < b; return 1;
+        case Expression::Op::Gt: *out = a > b; return 1;
+        case Expression::Op::Le: *out = a <= b; return 1;
+        case Expression::Op::Ge: *out = a >= b; return 1;
+        default: return 0;
+    }
+    if (!roundReal(r)) return 0;
+    std::memcpy(out, &r, sizeof(r));
+    return 1;
+}
+
+void collectAssigned(const std::vector<std::shared_ptr<Statement>>& statements, std::set<Symbol>& out) {
+    for (auto& stmt : statements) {
+        if (stmt->kind == Statement::Kind::Assign || stmt->kind == Statement::Kind::For) out.insert(stmt->name);
+        collectAssigned(stmt->body, out);
+    }
+}
+
+bool plain(Symbol name) { return name.str().find('.') == std::string::npos; }
+
+// The compiled-function target of a call from `fn`, if it has one.
+JitFunction* callTarget(JitFunction& fn, Expression* call, const std::set<Symbol>& locals) {
+    Symbol head(std::string_view(call->name.str()).substr(0, call->name.str().find('.')));
+    if (locals.count(head)) return nullptr;
+    auto var = fn.body->lookupVariable(call->name.str());
+    if (!var || !var->children.count("__jit")) return nullptr;
+    auto* holder = std::any_cast<std::shared_ptr<JitFunction>>(&var->children["__jit"]->value);
+    return holder && !(*holder)->memo ? holder->get() : nullptr;
+}
+
+// Fixed-point type inference over a function body. Parameters start from the
+// profiled argument types; every local gets the join of the types assigned
+// to it and the function the join of what it returns. Callees are compiled
+// (specialized to this call site's argument types when they have never run)
+// so their result types are known. Only Jit::compile runs it; the optimizer
+// and the interpreter do not.
+class Inference {
+public:
+    std::set<Symbol> names; // parameters and assigned locals
+    std::map<Symbol, Type> locals;
+    Type result = Type::None;
+
+    Inference(JitFunction& fn) : fn(fn) {}
+
+    bool run() {
+        collectAssigned(fn.body->statements, names);
+        for (size_t i = 0; i < fn.params.size(); ++i) {
+            names.insert(fn.params[i]);
+            if (i >= fn.arg_types.size() || !numeric(fn.arg_types[i])) return false;
+            locals[fn.params[i]] = fn.arg_types[i];
+        }
+        // Types only move up a lattice of height 3, so this terminates.
+        do {
+            changed = false;
+            block(fn.body->statements);
+        } while (changed);
+        return result != Type::Any;
+    }
+
+    Type local(Symbol name) const {
+        auto it = locals.find(name);
+        return it == locals.end() ? Type::None : it->second;
+    }
+
+    Type type(Expression* e) {
+        switch (e->kind) {
+            case Expression::Kind::Literal: {
+                int64_t bits;
+                return valueType(e->literal.view(), bits);
+            }
+            case Expression::Kind::Variable:
+                return plain(e->name) && names.count(e->name) ? local(e->name) : Type::Any;
+            case Expression::Kind::Call:
+                return call(e);
+            case Expression::Kind::Unary: {
+                Type t = type(e->children[0].get());
+                return e->op == Expression::Op::Not && numeric(t) ? Type::Int : t;
+            }
+            case Expression::Kind::Binary:
+                break;
+            default:
+                return Type::Any;
+        }
+        Type l = type(e->children[0].get());
+        Type r = type(e->children[1].get());
+        if (l == Type::Any || r == Type::Any) return Type::Any;
+        switch (e->op) {
+            case Expression::Op::Add:
+            case Expression::Op::Sub:
+            case Expression::Op::Mul:
+            case Expression::Op::Div:
+            case Expression::Op::Mod:
+                if (l == Type::None || r == Type::None) return Type::None;
+                return l == Type::Int && r == Type::Int ? Type::Int : Type::Float;
+            case Expression::Op::Pow:
+            case Expression::Op::In:
+                return Type::Any;
+            default:
+                return Type::Int; // comparisons, && and || give "1" / "0"
+        }
+    }
+
+private:
+    JitFunction& fn;
+    bool changed = false;
+
+    void assign(Symbol name, Type t) {
+        Type joined = join(local(name), t);
+        if (joined != local(name)) {
+            locals[name] = joined;
+            changed = true;
+        }
+    }
+
+    void block(const std::vector<std::shared_ptr<Statement>>& statements) {
+        for (auto& stmt : statements) {
+            switch (stmt->kind) {
+                case Statement::Kind::Assign:
+                    assign(stmt->name, type(stmt->expression.get()));
+                    break;
+                case Statement::Kind::Return:
+                    if (stmt->expression) {
+                        Type joined = join(result, type(stmt->expression.get()));
+                        if (joined != result) {
+                            result = joined;
+                            changed = true;
+                        }
+                    }
+                    break;
+                case Statement::Kind::For:
+                    for (auto& bound : stmt->expression->children) type(bound.get());
+                    assign(stmt->name, Type::Int);
+                    block(stmt->body);
+                    break;
+                case Statement::Kind::While:
+                    type(stmt->expression.get());
+                    block(stmt->body);
+                    break;
+                default:
+                    if (stmt->expression) type(stmt->expression.get());
+                    break;
+            }
+        }
+    }
+
+    Type call(Expression* e) {
+        JitFunction* callee = callTarget(fn, e, names);
+        if (!callee) return Type::Any;
+        std::vector<Type> args;
+        for (auto& arg : e->children) args.push_back(type(arg.get()));
+        for (Type t : args) {
+            if (!numeric(t)) return t == Type::None ? Type::None : Type::Any;
+        }
+        if (args.size() < callee->params.size()) return Type::Any;
+        if (callee->state == JitFunction::State::Cold) {
+            if (callee->arg_types.empty()) callee->arg_types.assign(args.begin(), args.begin() + callee->params.size());
+            Jit::compile(*callee);
+        }
+        if (callee->state == JitFunction::State::Failed) return Type::Any;
+        for (size_t i = 0; i < callee->params.size(); ++i) {
+            if (args[i] != callee->arg_types[i]) return Type::Any;
+        }
+        if (callee == &fn) return result;
+        if (callee->state == JitFunction::State::Compiling) {
+            callee->result_assumed = true;
+            return Type::Int;
+        }
+        return callee->result_type == Type::None ? Type::Int : callee->result_type; // None: the call bails
+    }
+};
+
+// Template compiler over the inferred types: checks that a construct is
+// supported while emitting it, and gives up (returns false) on the first one
+// that is not.
+class Compiler {
+public:
+    Compiler(JitFunction& fn) : types(fn), fn(fn) {}
+
+    bool run() {
+        if (!types.run()) return false;
+        bail = a.label();
+        deep = a.label();
+        epilogue = a.label();
+        body = a.label();
+
+        // Frame: [rbp-8] result ptr, [rbp-16] ctx, [rbp-24] call scratch,
+        // [rbp-32] "result passes through && / ||" flag, locals below.
+        a.emit({0x55, 0x48, 0x89, 0xE5});                        // push rbp; mov rbp, rsp
+        a.emit({0x48, 0x81, 0xEC});                               // sub rsp, frame
+        size_t frame_pos = a.code.size();
+        a.imm32(0);
+        a.store(RSI, -8);
+        a.store(RDX, -16);
+        a.emit({0x48, 0x89, 0xD0, 0xFF, 0x00, 0x81, 0x38});      // mov rax, rdx; inc [rax]; cmp [rax], max_depth
+        a.imm32(max_depth);
+        a.jcc(G, deep);
+        a.storeImm(-32, 0);
+        std::set<Symbol> defined;
+        for (size_t i = 0; i < fn.params.size(); ++i) {
+            a.emit({0x48, 0x8B, 0x87});                           // mov rax, [rdi + 8i]
+            a.imm32(static_cast<int32_t>(8 * i));
+            a.store(RAX, slot(fn.params[i]));
+            defined.insert(fn.params[i]);
+        }
+        a.bind(body);
+        if (!block(fn.body->statements, defined)) return false;
+        returnNone();
+
+        a.bind(deep);
+        a.emit({0xC7, 0x40, 0x04, 0x01, 0x00, 0x00, 0x00});      // mov dword [rax+4], 1
+        a.bind(bail);
+        a.status(2);
+        a.bind(epilogue);
+        a.load(RCX, -16);
+        a.emit({0xFF, 0x09, 0x48, 0x89, 0xEC, 0x5D, 0xC3});      // dec [rcx]; mov rsp, rbp; pop rbp; ret
+
+        int32_t size = (frame + 15) & ~15;
+        std::memcpy(&a.code[frame_pos], &size, 4);
+        return a.finish();
+    }
+
+    Assembler a;
+    Inference types;
+
+private:
+    JitFunction& fn;
+    std::map<Symbol, int32_t> slots;
+    int32_t frame = 32;
+    int pushed = 0; // 8-byte pushes outstanding, for call alignment
+    int bail, deep, epilogue, body;
+
+    int32_t slot(Symbol name) {
+        auto it = slots.find(name);
+        if (it != slots.end()) return it->second;
+        frame += 8;
+        return slots[name] = -frame;
+    }
+    int32_t hidden() {
+        frame += 8;
+        return -frame;
+    }
+    bool block(const std::vector<std::shared_ptr<Statement>>& statements, std::set<Symbol>& defined) {
+        for (auto& stmt : statements) {
+            switch (stmt->kind) {
+                case Statement::Kind::Assign:
+                    if (!plain(stmt->name) || !numeric(types.local(stmt->name)) || !expr(stmt->expression.get(), defined)) return false;
+                    a.store(RAX, slot(stmt->name));
+                    defined.insert(stmt->name);
+                    break;
+                case Statement::Kind::Expression:
+                    if (stmt->block || !expr(stmt->expression.get(), defined)) return false;
+                    break;
+                case Statement::Kind::Return:
+                    if (!ret(stmt->expression.get(), defined)) return false;
+                    break;
+                case Statement::Kind::While: {
+                    int top = a.label(), end = a.label();
+                    a.bind(top);
+                    if (!expr(stmt->expression.get(), defined)) return false;
+                    a.testRax();
+                    a.jcc(E, end);
+                    std::set<Symbol> inner = defined; // body assignments may not happen
+                    if (!block(stmt->body, inner)) return false;
+                    a.jmp(top);
+                    a.bind(end);
+                    break;
+                }
+                case Statement::Kind::For:
+                    if (!loop(*stmt, defined)) return false;
+                    break;
+                default:
+                    return false; // imports
+            }
+        }
+        return true;
+    }
+
+    bool loop(const Statement& stmt, std::set<Symbol>& defined) {
+        if (!plain(stmt.name)) return false;
+        if (stmt.expression->kind != Expression::Kind::Call || stmt.expression->name != Symbol("range")) return false;
+        auto& given = stmt.expression->children;
+        int32_t bounds[3] = {hidden(), hidden(), hidden()}; // start, stop, step
+        a.movImm(0);
+        a.store(RAX, bounds[0]);
+        a.movImm(1);
+        a.store(RAX, bounds[2]);
+        for (size_t i = 0; i < given.size(); ++i) {
+            if (types.type(given[i].get()) != Type::Int || !expr(given[i].get(), defined)) return false;
+            a.store(RAX, bounds[given.size() == 1 ? 1 : i]);
+        }
+        a.load(RAX, bounds[2]);
+        a.testRax();
+        a.jcc(E, bail); // step 0: the interpreter reports it
+
+        int top = a.label(), positive = a.label(), run = a.label(), end = a.label();
+        int32_t counter = bounds[0];
+        a.bind(top);
+        a.load(RAX, counter);
+        a.load(RCX, bounds[1]);
+        a.load(RDX, bounds[2]);
+        a.emit({0x48, 0x85, 0xD2});                               // test rdx, rdx
+        a.jcc(G, positive);
+        a.emit({0x48, 0x39, 0xC8});                               // cmp rax, rcx
+        a.jcc(LE, end);
+        a.jmp(run);
+        a.bind(positive);
+        a.emit({0x48, 0x39, 0xC8});
+        a.jcc(GE, end);
+        a.bind(run);
+        a.store(RAX, slot(stmt.name));
+        std::set<Symbol> inner = defined;
+        inner.insert(stmt.name);
+        if (!block(stmt.body, inner)) return false;
+        a.load(RAX, counter);
+        a.load(RDX, bounds[2]);
+        a.emit({0x48, 0x01, 0xD0});                               // add rax, rdx
+        a.jcc(O, bail);
+        a.store(RAX, counter);
+        a.jmp(top);
+        a.bind(end);
+        return true;
+    }
+
+    // Value in rax -> *result, boolean if it came through && / ||.
+    void returnValue() {
+        int store = a.label();
+        a.load(RCX, -32);
+        a.emit({0x48, 0x85, 0xC9});                               // test rcx, rcx
+        a.jcc(E, store);
+        a.testRax();
+        a.setcc(NE);
+        a.bind(store);
+        a.load(RCX, -8);
+        a.emit({0x48, 0x89, 0x01, 0x31, 0xC0});                   // mov [rcx], rax; xor eax, eax
+        a.jmp(epilogue);
+    }
+
+    void returnNone() {
+        int none = a.label();
+        a.load(RCX, -32);
+        a.emit({0x48, 0x85, 0xC9});
+        a.jcc(E, none);
+        a.emit({0x31, 0xC0});                                     // boolean of nothing is 0
+        returnValue();
+        a.bind(none);
+        a.status(1);
+        a.jmp(epilogue);
+    }
+
+    JitFunction* target(Expression* call) { return callTarget(fn, call, types.names); }
+
+    // Arguments already proven to have the types `callee` is specialized to.
+    bool matches(Expression* call, JitFunction& callee) {
+        if (call->children.size() < callee.params.size() || callee.arg_types.size() < callee.params.size()) return false;
+        for (size_t i = 0; i < callee.params.size(); ++i) {
+            if (types.type(call->children[i].get()) != callee.arg_types[i]) return false;
+        }
+        return true;
+    }
+
+    // Bail if the callee's name was rebound since compilation.
+    void guard(Expression* call) {
+        Symbol head(std::string_view(call->name.str()).substr(0, call->name.str().find('.')));
+        a.movImm(reinterpret_cast<int64_t>(Interner::get().versionAddress(head.id)));
+        a.emit({0x81, 0x38});                                     // cmp dword [rax], version
+        a.imm32(static_cast<int32_t>(head.version()));
+        a.jcc(NE, bail);
+    }
+
+    bool ret(Expression* e, std::set<Symbol>& defined) {
+        if (!e) {
+            returnNone();
+            return true;
+        }
+        Expression* leaf = e;
+        while (leaf->kind == Expression::Kind::Binary && (leaf->op == Expression::Op::And || leaf->op == Expression::Op::Or)) {
+            leaf = leaf->children[1].get();
+        }
+        bool self_tail = leaf->kind == Expression::Kind::Call && target(leaf) == &fn && matches(leaf, fn);
+        if (!self_tail) {
+            if (!expr(e, defined)) return false;
+            returnValue();
+            return true;
+        }
+
+        // Tail call to ourselves: a jump back to the top with new parameters.
+        while (e != leaf) {
+            if (!expr(e->children[0].get(), defined)) return false;
+            bool is_and = e->op == Expression::Op::And;
+            int next = a.label();
+            a.testRax();
+            a.jcc(is_and ? NE : E, next);
+            a.status(is_and ? 0 : 1);
+            returnValue();
+            a.bind(next);
+            a.storeImm(-32, 1);
+            e = e->children[1].get();
+        }
+        guard(leaf);
+        for (size_t i = 0; i < fn.params.size(); ++i) {
+            if (!expr(leaf->children[i].get(), defined)) return false;
+            a.push();
+            pushed++;
+        }
+        for (size_t i = fn.params.size(); i-- > 0;) {
+            a.pop(RAX);
+            pushed--;
+            a.store(RAX, slot(fn.params[i]));
+        }
+        a.jmp(body);
+        return true;
+    }
+
+    bool call(Expression* e, std::set<Symbol>& defined) {
+        JitFunction* callee = target(e); // compiled by inference
+        if (!callee || callee->state == JitFunction::State::Failed || callee->state == JitFunction::State::Cold || !matches(e, *callee)) return false;
+
+        guard(e);
+        size_t n = callee->params.size(); // extra arguments are ignored by the callee
+        int pad = (pushed + n) % 2;
+        if (pad) a.emit({0x48, 0x83, 0xEC, 0x08});                // sub rsp, 8
+        pushed += pad;
+        for (size_t i = n; i-- > 0;) {
+            if (!expr(e->children[i].get(), defined)) return false;
+            a.push();
+            pushed++;
+        }
+        a.emit({0x48, 0x89, 0xE7, 0x48, 0x8D, 0xB5});            // mov rdi, rsp; lea rsi, [rbp-24]
+        a.imm32(-24);
+        a.load(RDX, -16);
+        a.movImm(reinterpret_cast<int64_t>(&callee->entry));
+        a.emit({0xFF, 0x10});                                     // call [rax]
+        a.emit({0x48, 0x81, 0xC4});                               // add rsp, 8 * (n + pad)
+        a.imm32(static_cast<int32_t>(8 * (n + pad)));
+        pushed -= static_cast<int>(n) + pad;
+        a.emit({0x85, 0xC0});                                     // test eax, eax
+        a.jcc(NE, bail);
+        a.load(RAX, -24);
+        return true;
+    }
+
+    // rax op rcx through realOp, the result in rax.
+    void real(Expression::Op op, Type lt, Type rt) {
+        int32_t code = static_cast<int32_t>(op) | (lt == Type::Float ? 0x100 : 0) | (rt == Type::Float ? 0x200 : 0);
+        a.emit({0x48, 0x89, 0xCA, 0x48, 0x89, 0xC6, 0xBF});      // mov rdx, rcx; mov rsi, rax; mov edi, code
+        a.imm32(code);
+        a.emit({0x48, 0x8D, 0x8D});                               // lea rcx, [rbp-24]
+        a.imm32(-24);
+        int pad = pushed % 2;
+        if (pad) a.emit({0x48, 0x83, 0xEC, 0x08});                // sub rsp, 8
+        a.movImm(reinterpret_cast<int64_t>(&realOp));
+        a.emit({0xFF, 0xD0});                                     // call rax
+        if (pad) a.emit({0x48, 0x83, 0xC4, 0x08});                // add rsp, 8
+        a.emit({0x85, 0xC0});                                     // test eax, eax
+        a.jcc(E, bail);
+        a.load(RAX, -24);
+    }
+
+    bool expr(Expression* e, std::set<Symbol>& defined) {
+        switch (e->kind) {
+            case Expression::Kind::Literal: {
+                int64_t bits;
+                if (!numeric(valueType(e->literal.view(), bits))) return false;
+                a.movImm(bits);
+                return true;
+            }
+            case Expression::Kind::Variable:
+                // Only names this function has certainly bound; others are globals or bare text.
+                if (!plain(e->name) || !defined.count(e->name) || !numeric(types.local(e->name))) return false;
+                a.load(RAX, slot(e->name));
+                return true;
+            case Expression::Kind::Call:
+                return call(e, defined);
+            case Expression::Kind::Unary:
+                if (!expr(e->children[0].get(), defined)) return false;
+                if (e->op == Expression::Op::Not) {
+                    a.testRax();                                  // floats here are never zero
+                    a.setcc(E);
+                } else if (types.type(e->children[0].get()) == Type::Float) {
+                    a.emit({0x48, 0x0F, 0xBA, 0xF8, 0x3F});       // btc rax, 63
+                } else {
+                    a.emit({0x48, 0xF7, 0xD8});                   // neg rax
+                    a.jcc(O, bail);
+                }
+                return true;
+            case Expression::Kind::Binary:
+                break;
+            default:
+                return false; // lists, maps, indexing
+        }
+
+        if (e->op == Expression::Op::And || e->op == Expression::Op::Or) {
+            bool is_and = e->op == Expression::Op::And;
+            int decided = a.label(), end = a.label();
+            if (!expr(e->children[0].get(), defined)) return false;
+            a.testRax();
+            a.jcc(is_and ? E : NE, decided);
+            if (!expr(e->children[1].get(), defined)) return false;
+            a.testRax();
+            a.setcc(NE);
+            a.jmp(end);
+            a.bind(decided);
+            a.status(is_and ? 0 : 1);
+            a.bind(end);
+            return true;
+        }
+        if (e->op == Expression::Op::Pow || e->op == Expression::Op::In) return false;
+
+        Type lt = types.type(e->children[0].get());
+        Type rt = types.type(e->children[1].get());
+        if (!numeric(lt) || !numeric(rt)) return false;
+        if (!expr(e->children[0].get(), defined)) return false;
+        a.push();
+        pushed++;
+        if (!expr(e->children[1].get(), defined)) return false;
+        a.emit({0x48, 0x89, 0xC1});                               // mov rcx, rax
+        a.pop(RAX);
+        pushed--;
+        if (lt == Type::Float || rt == Type::Float) {
+            real(e->op, lt, rt);
+            return true;
+        }
+        switch (e->op) {
+            case Expression::Op::Add: a.emit({0x48, 0x01, 0xC8}); a.jcc(O, bail); break;       // add rax, rcx
+            case Expression::Op::Sub: a.emit({0x48, 0x29, 0xC8}); a.jcc(O, bail); break;       // sub rax, rcx
+            case Expression::Op::Mul: a.emit({0x48, 0x0F, 0xAF, 0xC1}); a.jcc(O, bail); break; // imul rax, rcx
+            case Expression::Op::Div:
+            case Expression::Op::Mod: {
+                int ok = a.label();
+                a.emit({0x48, 0x85, 0xC9});                       // test rcx, rcx
+                a.jcc(E, bail);
+                a.emit({0x48, 0x83, 0xF9, 0xFF});                 // cmp rcx, -1
+                a.jcc(NE, ok);
+                a.emit({0x48, 0xBA});                             // mov rdx, INT64_MIN
+                a.imm64(INT64_MIN);
+                a.emit({0x48, 0x39, 0xD0});                       // cmp rax, rdx
+                a.jcc(E, bail);
+                a.bind(ok);
+                a.emit({0x48, 0x99, 0x48, 0xF7, 0xF9});           // cqo; idiv rcx
+                if (e->op == Expression::Op::Mod) a.emit({0x48, 0x89, 0xD0}); // mov rax, rdx
+                break;
+            }
+            case Expression::Op::Eq: a.emit({0x48, 0x39, 0xC8}); a.setcc(E); break;   // cmp rax, rcx
+            case Expression::Op::Ne: a.emit({0x48, 0x39, 0xC8}); a.setcc(NE); break;
+            case Expression::Op::Lt: a.emit({0x48, 0x39, 0xC8}); a.setcc(L); break;
+            case Expression::Op::Gt: a.emit({0x48, 0x39, 0xC8}); a.setcc(G); break;
+            case Expression::Op::Le: a.emit({0x48, 0x39, 0xC8}); a.setcc(LE); break;
+            case Expression::Op::Ge: a.emit({0x48, 0x39, 0xC8}); a.setcc(GE); break;
+            default: return false;
+        }
+        return true;
+    }
+};
+
+}
+
+JitFunction::JitFunction(Parser* body, std::vector<Symbol> params) : body(body), params(std::move(params)), entry(bailStub()) {
+    for (auto& stmt : body->statements) {
+        if (stmt->kind == Statement::Kind::While || stmt->kind == Statement::Kind::For) has_loop = true;
+    }
+}
+
+JitFunction::~JitFunction() {
+    if (code) munmap(code, code_size);
+}
+
+bool JitFunction::run(Args args, std::any& result) {
+    if (state == State::Cold) {
+        arg_types.resize(params.size(), Type::None);
+        for (size_t i = 0; i < params.size(); ++i) {
+            int64_t bits;
+            arg_types[i] = join(arg_types[i], i < args.size() ? valueType(args[i], bits) : Type::Any);
+        }
+    }
+    if (state != State::Compiled) {
+        if (state != State::Cold || (++calls < Jit::threshold && !has_loop)) return false;
+        if (!Jit::compile(*this)) return false;
+    }
+    if (args.size() < params.size()) return false;
+
+    // Guard: every argument must have its specialized type, in text the
+    // interpreter would print the same way.
+    int64_t inline_values[8];
+    std::vector<int64_t> heap_values;
+    int64_t* values = inline_values;
+    if (params.size() > 8) {
+        heap_values.resize(params.size());
+        values = heap_values.data();
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (valueType(args[i], values[i]) != arg_types[i]) return false;
+    }
+
+    int ctx[2] = {0, 0};
+    int64_t value = 0;
+    int status = reinterpret_cast<NativeFn>(entry)(values, &value, ctx);
+    if (status == 0) {
+        if (result_type == Type::Float) {
+            double d;
+            std::memcpy(&d, &value, sizeof(d));
+            char buf[32];
+            result = String(std::string(buf, std::snprintf(buf, sizeof(buf), "%.15g", d)));
+        } else {
+            result = String(std::to_string(value));
+        }
+        return true;
+    }
+    if (status == 1) {
+        result.reset();
+        return true;
+    }
+    // Bailed: the interpreter runs this call. Deep recursion (better served by
+    // the interpreter's tail calls) or frequent bails retire the native code.
+    if (ctx[1] || ++bails > max_bails) {
+        state = State::Failed;
+        entry = bailStub();
+    }
+    return false;
+}
+
+bool Jit::compile(JitFunction& function) {
+    if (function.state != JitFunction::State::Cold) return function.state == JitFunction::State::Compiled;
+    function.state = JitFunction::State::Compiling;
+    Compiler compiler(function);
+    bool ok = compiler.run();
+    function.result_type = compiler.types.result;
+    // Callers compiled meanwhile took an Int result on trust.
+    if (function.result_assumed && function.result_type == Type::Float) ok = false;
+    void* code = ok ? mapCode(compiler.a.code, function.code_size) : nullptr;
+    if (!code) {
+        function.state = JitFunction::State::Failed;
+        return false;
+    }
+    function.code = code;
+    function.entry = code;
+    function.state = JitFunction::State::Compiled;
+    return true;
+}
+
+}
@@ -0,0 +1,72 @@
+#ifndef SERVO_INTERNAL_PRIVATE_JIT_HPP
+#define SERVO_INTERNAL_PRIVATE_JIT_HPP
+
+#include <any>
+#include <cstdint>
+#include <vector>
+#include "../public/symbol.hpp"
+#include "../public/variable.hpp"
+
+namespace servo {
+
+class Parser;
+
+// Tiering state of one user function (see Parser::defineFunction). After
+// Jit::threshold interpreted calls, or on the first call when the body has a
+// loop, the body is compiled to x86-64 if type inference proves it only does
+// numeric work: parameters and locals, number literals, arithmetic,
+// comparisons, && / ||, while / for-in-range loops and calls to other such
+// functions. Anything else (strings, builtins, blocks, globals) keeps the
+// function interpreted.
+//
+// Inference starts from the argument types seen by the interpreted calls and
+// gives every local the join of what is assigned to it: Int (int64) and
+// Float (double) are compiled, a mix of the two or any text is not.
+// Compiled code bails out to the interpreter on anything the interpreter
+// would handle differently: arguments of other types, overflow, division by
+// zero, a float result that would print as an integer, a rebound callee,
+// deep recursion. Such bodies have no side effects, so bailing simply re-runs
+// the call interpreted.
+//
+// Inference is part of this tier only. Without --jit, in functions it does
+// not compile, and in --emit-cpp programs, values stay text and `+` still
+// chooses between addition and concatenation from its operands at run time.
+class JitFunction {
+public:
+    enum class State { Cold, Compiling, Compiled, Failed };
+    enum class Type : uint8_t { None, Int, Float, Any }; // None: not seen yet
+
+    Parser* body;
+    std::vector<Symbol> params;
+    State state = State::Cold;
+    uint32_t calls = 0;
+    uint32_t bails = 0;
+    bool has_loop = false;
+    bool memo = false; // `memo fn`: callers go through its table, never straight to native code
+    std::vector<Type> arg_types; // joined over interpreted calls; compiled code is specialized to them
+    Type result_type = Type::None;
+    bool result_assumed = false; // a caller compiled while this was compiling assumed an Int result
+    void* entry; // native code, or a stub that always bails
+    void* code = nullptr;
+    size_t code_size = 0;
+
+    JitFunction(Parser* body, std::vector<Symbol> params);
+    ~JitFunction();
+    JitFunction(const JitFunction&) = delete;
+    JitFunction& operator=(const JitFunction&) = delete;
+
+    // Run natively when compiled (compiling first once hot); false means the
+    // caller must interpret this call.
+    bool run(Args args, std::any& result);
+};
+
+class Jit {
+public:
+    static bool enabled;        // --jit
+    static uint32_t threshold;  // interpreted calls before compiling
+    static bool compile(JitFunction& function);
+};
+
+}
+
+#endif
@@ -0,0 +1,108 @@
+#include "memo.hpp"
+#include "../public/expression.hpp"
+#include "../public/collection.hpp"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace servo {
+
+bool Memo::stats = false;
+
+namespace {
+
+std::mutex registry_mutex;
+
+}
+
+std::set<Memo*>& Memo::live() {
+    static std::set<Memo*> tables;
+    return tables;
+}
+
+std::map<Symbol, Memo::Counters>& Memo::retired() {
+    static std::map<Symbol, Counters> totals;
+    return totals;
+}
+
+void Memo::add(std::map<Symbol, Counters>& totals, const Counters& c) {
+    auto& t = totals.try_emplace(c.name, Counters{c.name}).first->second;
+    t.hits += c.hits;
+    t.misses += c.misses;
+    t.evictions += c.evictions;
+}
+
+Memo::Memo(Symbol name, size_t capacity) : capacity(capacity), counters{name} {
+    index.reserve(std::min<size_t>(capacity, 1024));
+    if (!stats) return;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    live().insert(this);
+}
+
+Memo::~Memo() {
+    if (!stats) return;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if (live().erase(this)) add(retired(), counters);
+}
+
+bool Memo::key(Args args) {
+    // Length-prefixed so ("a,b") and ("a", "b") differ.
+    scratch.clear();
+    for (auto& arg : args) {
+        // Only strings are keys: lists and maps change under the same
+        // identity, and blocks and other values have no text to tell apart.
+        if (arg.type() != typeid(String) && arg.type() != typeid(std::string)) return false;
+        String text = Expression::toString(arg);
+        uint32_t size = static_cast<uint32_t>(text.size());
+        scratch.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        scratch.append(text.view());
+    }
+    return true;
+}
+
+bool Memo::lookup(Args args, std::any& result) {
+    auto it = key(args) ? index.find(scratch) : index.end();
+    if (it == index.end()) {
+        counters.misses++;
+        return false;
+    }
+    counters.hits++;
+    order.splice(order.begin(), order, it->second);
+    result = it->second->value;
+    return true;
+}
+
+void Memo::store(Args args, const std::any& result) {
+    // A list or map result would be shared by every later caller.
+    if (result.type() == typeid(List) || result.type() == typeid(Map)) return;
+    if (!key(args)) return; // the body may have run other lookups since
+    if (index.count(scratch)) return; // a recursive call stored it already
+    if (order.size() >= capacity) {
+        index.erase(order.back().key);
+        order.pop_back();
+        counters.evictions++;
+    }
+    order.push_front(Entry{scratch, result});
+    index.emplace(order.front().key, order.begin());
+}
+
+void Memo::report(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::map<Symbol, Counters> totals = retired();
+    for (Memo* table : live()) add(totals, table->counters);
+    std::vector<Counters> rows;
+    for (auto& [name, t] : totals) rows.push_back(t);
+    std::sort(rows.begin(), rows.end(), [](const Counters& a, const Counters& b) {
+        return a.hits + a.misses > b.hits + b.misses;
+    });
+    out << "\033[1m[servo@spp]\033[0m memo stats (" << rows.size() << " functions)\n";
+    for (auto& r : rows) {
+        uint64_t calls = r.hits + r.misses;
+        out << "  " << r.name.str() << ": " << r.hits << " hits, " << r.misses << " misses";
+        if (calls) out << " (" << (100 * r.hits / calls) << "% hit)";
+        if (r.evictions) out << ", " << r.evictions << " evicted";
+        out << "\n";
+    }
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef SERVO_INTERNAL_PRIVATE_MEMO_HPP
+#define SERVO_INTERNAL_PRIVATE_MEMO_HPP
+
+#include <any>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "../public/symbol.hpp"
+#include "../public/variable.hpp"
+
+namespace servo {
+
+// Result cache of one `memo fn`: argument values -> result, bounded, with
+// least-recently-used eviction. Tables belong to a function definition and,
+// like its body parser, are only used by the thread that defined it. Only
+// calls whose arguments are all strings are cached, and only when the result
+// is not a list or map, which the caller could change.
+class Memo {
+public:
+    static constexpr size_t default_capacity = 4096;
+    static bool stats; // --stats: report hits / misses at exit
+
+    explicit Memo(Symbol name, size_t capacity = default_capacity);
+    ~Memo();
+    Memo(const Memo&) = delete;
+    Memo& operator=(const Memo&) = delete;
+
+    bool lookup(Args args, std::any& result);
+    void store(Args args, const std::any& result);
+
+    // Totals per function name over all tables, hottest first. Tables are
+    // only registered under --stats; a dropped table's counts are folded
+    // into its name's totals, so a long batch holds one row per name.
+    static void report(std::ostream& out);
+
+private:
+    struct Counters {
+        Symbol name;
+        uint64_t hits = 0, misses = 0, evictions = 0;
+    };
+    struct Entry {
+        std::string key;
+        std::any value;
+    };
+
+    size_t capacity;
+    Counters counters;
+    std::list<Entry> order; // most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index; // keys point into order
+    std::string scratch;
+
+    bool key(Args args); // encodes args into scratch; false when they cannot be a key
+    static std::set<Memo*>& live();
+    static std::map<Symbol, Counters>& retired();
+    static void add(std::map<Symbol, Counters>& totals, const Counters& c);
+};
+
+}
+
+#endif
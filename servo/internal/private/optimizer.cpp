@@ -0,0 +1,66 @@
+#include "optimizer.hpp"
+#include <exception>
+
+namespace servo {
+
+namespace {
+
+std::shared_ptr<Expression> literal(const std::any& value) {
+    auto node = std::make_shared<Expression>(Expression::Kind::Literal);
+    node->literal = Expression::toString(value);
+    return node;
+}
+
+bool isLiteral(const std::shared_ptr<Expression>& expr) {
+    return expr->kind == Expression::Kind::Literal;
+}
+
+}
+
+std::shared_ptr<Expression> Optimizer::fold(const std::shared_ptr<Expression>& expr) {
+    if (!expr) return expr;
+    for (auto& child : expr->children) child = fold(child);
+
+    if (expr->kind == Expression::Kind::Binary) {
+        auto& lhs = expr->children[0];
+        auto& rhs = expr->children[1];
+        // Short-circuit operators fold as soon as the left side decides them.
+        if ((expr->op == Expression::Op::And || expr->op == Expression::Op::Or) && isLiteral(lhs) && !isLiteral(rhs)) {
+            bool left = Expression::truthy(lhs->literal);
+            if (expr->op == Expression::Op::And && !left) return literal(String(Symbol("0")));
+            if (expr->op == Expression::Op::Or && left) return literal(String(Symbol("1")));
+            return expr;
+        }
+        if (!isLiteral(lhs) || !isLiteral(rhs)) return expr;
+    } else if (expr->kind == Expression::Kind::Unary) {
+        if (!isLiteral(expr->children[0])) return expr;
+    } else {
+        return expr;
+    }
+
+    // Operands are constants, so evaluation never touches a pool.
+    try {
+        return literal(expr->evaluate(nullptr));
+    } catch (const std::exception&) {
+        return expr; // e.g. division by zero: leave it to fail at runtime
+    }
+}
+
+void Optimizer::run(std::vector<std::shared_ptr<Statement>>& statements) {
+    for (size_t i = 0; i < statements.size(); ++i) {
+        auto& stmt = statements[i];
+        stmt->expression = fold(stmt->expression);
+        if (stmt->kind == Statement::Kind::While && isLiteral(stmt->expression) && !Expression::truthy(stmt->expression->literal)) {
+            // `while 0 { ... }` never runs its body.
+            statements.erase(statements.begin() + i--);
+            continue;
+        }
+        if (stmt->kind == Statement::Kind::Return) {
+            // Nothing after a top-level return in this list can run.
+            statements.resize(i + 1);
+            break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,22 @@
+#ifndef SERVO_INTERNAL_PRIVATE_OPTIMIZER_HPP
+#define SERVO_INTERNAL_PRIVATE_OPTIMIZER_HPP
+
+#include <memory>
+#include <vector>
+#include "../public/expression.hpp"
+#include "../public/statement.hpp"
+
+namespace servo {
+
+// Rewrites a compiled statement list in place (enabled with -O1, the default):
+//  - folds arithmetic, comparisons and concatenations whose operands are literals
+//  - drops statements after an unconditional return, and loops that never run
+class Optimizer {
+public:
+    static void run(std::vector<std::shared_ptr<Statement>>& statements);
+    static std::shared_ptr<Expression> fold(const std::shared_ptr<Expression>& expr);
+};
+
+}
+
+#endif
@@ -5,74 +5,257 @@
 #include <stdexcept>
 #include <cctype>
 #include <sstream>
+#include <charconv>
 #include <cmath>
+#include <filesystem>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <algorithm>
 #include "../public/safe.hpp"
+#include "../public/binding.hpp"
+#include "expressionparser.hpp"
+#include "optimizer.hpp"
+#include "jit.hpp"
+#include "memo.hpp"
+#include "stack.hpp"
+#include "strings.hpp"
+#include "../public/linereader.hpp"
+#include "../public/collection.hpp"
 
 namespace servo {
 
-Parser::Parser(File file) : file(file) {
+int Parser::optimize_level = 1;
+bool Parser::lazy_imports = false;
+unsigned Parser::load_threads = std::max(1u, std::thread::hardware_concurrency());
+size_t Parser::max_depth = 100000;
+thread_local std::vector<Layer> Parser::sys_stack;
+
+namespace {
+
+// Modules are cached compiled, not run: every script run executes a module
+// again, at its first import, into a fresh copy of its compiled pool.
+struct CachedModule {
+    std::shared_ptr<Parser> parser;
+    std::filesystem::file_time_type mtime;
+    bool compiled = false;
+    std::map<Symbol, std::shared_ptr<Variable>> pool; // right after compiling: functions, no globals
+    uint64_t run = 0; // the script run that last executed it
+};
+thread_local std::map<std::string, CachedModule> module_cache;
+thread_local uint64_t script_run = 1;
+
+void collectImports(const std::vector<std::shared_ptr<Statement>>& statements, std::vector<std::string>& out) {
+    for (auto& stmt : statements) {
+        // Lazy imports are only read if and when they are used.
+        if (stmt->kind == Statement::Kind::Import && !stmt->lazy && !Parser::lazy_imports) out.push_back(stmt->name.str());
+        collectImports(stmt->body, out);
+    }
+}
+
+}
+
+std::shared_ptr<Variable> Parser::noopFunction() {
+    static auto noop = std::make_shared<Variable>("__noop",
+        Callable([](Args, std::any&) {}),
+        "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+    return noop;
+}
+
+bool Parser::isBlank(const std::string& code) {
+    // Only whitespace and # comments
+    bool comment = false;
+    for (char c : code) {
+        if (comment) { if (c == '\n') comment = false; }
+        else if (c == '#') comment = true;
+        else if (!isspace(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
+
+Parser::Parser(File file, Parser* parent) : file(file), parent(parent) {
     this->char_obj = nullptr;
-    // Pool init
-    this->pool["system"] = std::make_shared<Variable>("system", 
-        std::function<std::any(std::vector<std::any>)>([](std::vector<std::any> args) -> std::any {
-            std::string s;
-            if (!args.empty()) {
-                if (args[0].type() == typeid(String)) s = static_cast<std::string>(std::any_cast<String>(args[0]));
-                else if (args[0].type() == typeid(std::string)) s = std::any_cast<std::string>(args[0]);
-            }
-            Builtins::system(s);
-            return std::any();
-        }), 
-        "func", std::map<std::string, std::shared_ptr<Variable>>{}, this);
-
-    this->pool["systemreturn"] = std::make_shared<Variable>("systemreturn", 
-        std::function<std::any(std::vector<std::any>)>([](std::vector<std::any> args) -> std::any {
-             std::string s;
-             if (!args.empty()) {
-                if (args[0].type() == typeid(String)) s = static_cast<std::string>(std::any_cast<String>(args[0]));
-                else if (args[0].type() == typeid(std::string)) s = std::any_cast<std::string>(args[0]);
-             }
-             return std::any(String(Builtins::systemreturn(s)));
-        }), 
-        "func", std::map<std::string, std::shared_ptr<Variable>>{}, this);
-
-    // system_math placeholder - could be exposed math capabilities
-    // system_math
-    auto system_math = std::make_shared<Variable>("system_math", 0, "module", std::map<std::string, std::shared_ptr<Variable>>{}, this);
-    system_math->children["pi"] = std::make_shared<Variable>("pi", String("3.14159265359"), "float", std::map<std::string, std::shared_ptr<Variable>>{}, this);
-    
-    // helper for math functions
-    auto math_func = [this](std::string cmd_name) {
-         return std::function<std::any(std::vector<std::any>)>([cmd_name](std::vector<std::any> args) -> std::any {
-             if(args.empty()) return String("0");
-             std::string val_str;
-             if (args[0].type() == typeid(String)) val_str = static_cast<std::string>(std::any_cast<String>(args[0]));
-             else if (args[0].type() == typeid(std::string)) val_str = std::any_cast<std::string>(args[0]);
-             
-             // use bc -l for math functions? e.g. s(x), c(x)
-             std::string bc_func = "";
-             if (cmd_name == "sin") bc_func = "s";
-             else if (cmd_name == "cos") bc_func = "c";
-             else if (cmd_name == "tan") bc_func = "s/c"; // simplistic, bc -l has s, c, a, l, e, j
-             else if (cmd_name == "sqrt") bc_func = "sqrt";
-             
-             if (!bc_func.empty()) {
-                  std::string cmd = "echo \"" + bc_func + "(" + val_str + ")\" | bc -l";
-                  std::string res = Builtins::systemreturn(cmd);
-                  if(!res.empty() && res.back() == '\n') res.pop_back();
-                  return String(res);
-             }
-             return String("0");
-         });
-    };
+    // Pool init: the builtin Variables are shared, never copied per parser.
+    this->pool = Parser::builtins();
+}
 
-    system_math->children["sin"] = std::make_shared<Variable>("sin", math_func("sin"), "func", std::map<std::string, std::shared_ptr<Variable>>{}, this);
-    system_math->children["cos"] = std::make_shared<Variable>("cos", math_func("cos"), "func", std::map<std::string, std::shared_ptr<Variable>>{}, this);
-    system_math->children["sqrt"] = std::make_shared<Variable>("sqrt", math_func("sqrt"), "func", std::map<std::string, std::shared_ptr<Variable>>{}, this);
+const std::map<Symbol, std::shared_ptr<Variable>>& Parser::builtins() {
+    // Built once per process; the Variables are immutable afterwards, so any
+    // number of parsers (and threads) can hold them.
+    static const std::map<Symbol, std::shared_ptr<Variable>> table = [] {
+        std::map<Symbol, std::shared_ptr<Variable>> pool;
+        pool["system"] = servo::bind<&Builtins::system>("system");
+        pool["systemreturn"] = servo::bind<&Builtins::systemreturn>("systemreturn");
+
+        // print / eprint / write: buffered output (see Output)
+        auto output_func = [](const char* name, Output& (*target)(), bool newline) {
+            return std::make_shared<Variable>(name,
+                Callable([target, newline](Args args, std::any&) {
+                    Output::Line line(target());
+                    for (size_t i = 0; i < args.size(); ++i) {
+                        if (i > 0) line.put(" ");
+                        if (args[i].type() == typeid(String)) line.put(std::any_cast<const String&>(args[i]).view());
+                        else line.put(Expression::toString(args[i]).view());
+                    }
+                    if (newline) line.put("\n");
+                }),
+                "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        };
+        pool["print"] = output_func("print", &Output::out, true);
+        pool["eprint"] = output_func("eprint", &Output::err, true);
+        pool["write"] = output_func("write", &Output::out, false);
+        pool["flush"] = std::make_shared<Variable>("flush",
+            Callable([](Args, std::any&) { Output::flushAll(); }),
+            "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+
+        // system_math placeholder - could be exposed math capabilities
+        // system_math
+        auto system_math = std::make_shared<Variable>("system_math", 0, "module", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        system_math->children["pi"] = std::make_shared<Variable>("pi", String("3.14159265359"), "float", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+    
+        system_math->children["sin"] = servo::bind<&Builtins::sin>("sin");
+        system_math->children["cos"] = servo::bind<&Builtins::cos>("cos");
+        system_math->children["sqrt"] = servo::bind<&Builtins::sqrt>("sqrt");
     
-    this->pool["system_math"] = system_math;
-    // input placeholder
-     this->pool["input"] = std::make_shared<Variable>("input", 0, "func", std::map<std::string, std::shared_ptr<Variable>>{}, this);
+        pool["system_math"] = system_math;
+
+        // system_file
+        auto system_file = std::make_shared<Variable>("system_file", 0, "module", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        auto arg = [](Args args, size_t i) -> std::string {
+            return i < args.size() ? Expression::toString(args[i]).str() : std::string();
+        };
+        auto arg_offset = [arg](Args args, size_t i, uint64_t fallback) -> uint64_t {
+            std::string s = arg(args, i);
+            if (s.empty()) return fallback;
+            uint64_t v;
+            auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+            if (ec != std::errc() || end != s.data() + s.size()) throw std::runtime_error("expected a non-negative offset, got '" + s + "'");
+            return v;
+        };
+        auto file_func = [&system_file](const char* name, Callable fn) {
+            system_file->children[name] = std::make_shared<Variable>(name, std::move(fn), "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        };
+        // read(path) / read(path, offset, length)
+        file_func("read", [arg, arg_offset](Args args, std::any& result) {
+            result = String(Builtins::fileRead(arg(args, 0), arg_offset(args, 1, 0), arg_offset(args, 2, UINT64_MAX)));
+        });
+        file_func("write", [arg](Args args, std::any&) { Builtins::fileWrite(arg(args, 0), arg(args, 1)); });
+        file_func("append", [arg](Args args, std::any&) { Builtins::fileWrite(arg(args, 0), arg(args, 1), "a"); });
+        // write_at(path, offset, data)
+        file_func("write_at", [arg, arg_offset](Args args, std::any&) {
+            Builtins::fileWriteAt(arg(args, 0), arg_offset(args, 1, 0), arg(args, 2));
+        });
+        file_func("list", [arg](Args args, std::any& result) { result = String(Builtins::fileList(arg(args, 0))); });
+        file_func("size", [arg](Args args, std::any& result) { result = String(std::to_string(File(arg(args, 0), true).getSize())); });
+        file_func("type", [arg](Args args, std::any& result) { result = String(File(arg(args, 0), true).getType()); });
+        file_func("exists", [arg](Args args, std::any& result) { result = Expression::boolean(File(arg(args, 0), true).getExists()); });
+        file_func("delete", [arg](Args args, std::any& result) { result = Expression::boolean(File(arg(args, 0), true).deleteFile()); });
+        file_func("mkdir", [arg](Args args, std::any& result) { result = Expression::boolean(File(arg(args, 0), true).createDirectory()); });
+        pool["system_file"] = system_file;
+
+        // system_string: native text functions (see Strings)
+        auto system_string = std::make_shared<Variable>("system_string", 0, "module", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        auto string_func = [&system_string](const char* name, Callable fn) {
+            system_string->children[name] = std::make_shared<Variable>(name, std::move(fn), "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        };
+        auto text = [](Args args, size_t i) -> String {
+            return i < args.size() ? Expression::toString(args[i]) : String();
+        };
+        // find(s, needle[, from]): index of the first match, or -1
+        string_func("find", [text, arg_offset](Args args, std::any& result) {
+            size_t pos = Strings::find(text(args, 0).view(), text(args, 1).view(), arg_offset(args, 2, 0));
+            result = String(pos == Strings::npos ? std::string("-1") : std::to_string(pos));
+        });
+        system_string->children["count"] = servo::bind<&Strings::count>("count");
+        // split(s[, separator]): list of pieces; without a separator, splits on whitespace
+        string_func("split", [text](Args args, std::any& result) {
+            String s = text(args, 0);
+            auto pieces = Strings::split(s.view(), text(args, 1).view());
+            std::vector<std::any> items;
+            items.reserve(pieces.size());
+            for (auto piece : pieces) items.emplace_back(String(std::string(piece)));
+            result = List(std::move(items));
+        });
+        system_string->children["replace"] = servo::bind<&Strings::replace>("replace");
+        system_string->children["upper"] = servo::bind<&Strings::upper>("upper");
+        system_string->children["lower"] = servo::bind<&Strings::lower>("lower");
+        system_string->children["trim"] = servo::bind<&Strings::trim>("trim");
+        pool["system_string"] = system_string;
+        // input([prompt]): next line of stdin without its newline, "" at end of input
+        pool["input"] = std::make_shared<Variable>("input",
+            Callable([](Args args, std::any& result) {
+                if (!args.empty()) {
+                    Output::out().write(Expression::toString(args[0]).view());
+                    Output::out().flush();
+                }
+                std::string line;
+                result = LineReader::standardInput().nextLocked(line) ? String(std::move(line)) : String();
+            }),
+            "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+
+        // Lists and maps (see collection.hpp)
+        auto collection_func = [&pool](const char* name, Callable fn) {
+            pool[name] = std::make_shared<Variable>(name, std::move(fn), "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        };
+        auto list_arg = [](Args args, const char* name) -> List {
+            auto* list = args.empty() ? nullptr : std::any_cast<List>(&args[0]);
+            if (!list) throw std::runtime_error(std::string(name) + "() expects a list");
+            return *list;
+        };
+        auto map_arg = [](Args args, const char* name) -> Map {
+            auto* map = args.empty() ? nullptr : std::any_cast<Map>(&args[0]);
+            if (!map) throw std::runtime_error(std::string(name) + "() expects a map");
+            return *map;
+        };
+        // len(list / map / string)
+        collection_func("len", [](Args args, std::any& result) {
+            size_t n = 0;
+            if (args.empty()) {
+            } else if (auto* list = std::any_cast<List>(&args[0])) n = list->size();
+            else if (auto* map = std::any_cast<Map>(&args[0])) n = map->size();
+            else n = Expression::toString(args[0]).size();
+            result = String(std::to_string(n));
+        });
+        // append(list, value...): returns the list
+        collection_func("append", [list_arg](Args args, std::any& result) {
+            List list = list_arg(args, "append");
+            for (size_t i = 1; i < args.size(); ++i) list.append(args[i]);
+            result = list;
+        });
+        // pop(list): removes and returns the last item
+        collection_func("pop", [list_arg](Args args, std::any& result) {
+            List list = list_arg(args, "pop");
+            if (list.size() == 0) throw std::runtime_error("pop() from an empty list");
+            result = std::move(list.items().back());
+            list.items().pop_back();
+        });
+        collection_func("keys", [map_arg](Args args, std::any& result) {
+            std::vector<std::any> items;
+            for (auto& key : map_arg(args, "keys").keys()) items.emplace_back(key);
+            result = List(std::move(items));
+        });
+        collection_func("values", [map_arg](Args args, std::any& result) {
+            std::vector<std::any> items;
+            for (auto& e : map_arg(args, "values").entries()) {
+                if (e.live) items.push_back(e.value);
+            }
+            result = List(std::move(items));
+        });
+        // has(map, key) / has(list, value): same as `key in container`
+        collection_func("has", [](Args args, std::any& result) {
+            if (args.size() < 2) throw std::runtime_error("has() expects a container and a key");
+            result = Expression::boolean(Expression::contains(args[0], args[1]));
+        });
+        // remove(map, key): "1" when the key was present
+        collection_func("remove", [map_arg](Args args, std::any& result) {
+            if (args.size() < 2) throw std::runtime_error("remove() expects a map and a key");
+            result = Expression::boolean(map_arg(args, "remove").remove(Expression::mapKey(args[1])));
+        });
+        return pool;
+    }();
+    return table;
 }
 
 std::string Parser::getLastModeStackType() {
@@ -88,74 +271,123 @@ std::string Parser::wrap_strings(std::string expr) {
     return expr;
 }
 
-std::shared_ptr<Variable> Parser::findVariable(std::string name) {
-    if (pool.find(name) != pool.end()) {
-        auto val = pool[name];
-        // Handle derived / string wrapping logic...
-        return val;
-    }
-    // Dot access logic
-    size_t dot = name.find(".");
-    if (dot != std::string::npos) {
-        std::string part0 = name.substr(0, dot);
-        std::string part1 = name.substr(dot + 1); // Only support 1 level of dot for now?
-        // Recursion or loop for multi-level? simple loop
-        
-        // Loop logic
-        std::string current_name = part0;
-        std::string remainder = part1;
-        
-        if (pool.find(current_name) != pool.end()) {
-             auto current_var = pool[current_name];
-             // Navigate down
-             while(true) {
-                 size_t next_dot = remainder.find(".");
-                 std::string key = (next_dot == std::string::npos) ? remainder : remainder.substr(0, next_dot);
-                 std::string next_rem = (next_dot == std::string::npos) ? "" : remainder.substr(next_dot + 1);
-                 
-                 if (current_var->children.find(key) != current_var->children.end()) {
-                     current_var = current_var->children[key];
-                 } else {
-                     throw std::runtime_error("Variable '" + key + "' not found in '" + current_name + "'");
-                 }
-                 
-                 if (next_rem.empty()) return current_var;
-                 
-                 current_name += "." + key;
-                 remainder = next_rem;
-             }
+std::shared_ptr<Variable> Parser::findVariable(std::string_view name) {
+    auto var = lookupVariable(name);
+    if (!var) throw std::runtime_error("variable '" + std::string(name) + "' not found");
+    return var;
+}
+
+void Parser::bind(Symbol name, std::shared_ptr<Variable> var) {
+    name.touch();
+    auto& slot = this->pool[name];
+    if (this->activations > 0) this->undo_log.emplace_back(name, slot); // null: was unbound
+    slot = std::move(var);
+}
+
+void Parser::assign(Symbol name, std::any value) {
+    // In place only for a value bound by the running call (or at top level):
+    // in a recursive call the binding may be an outer activation's local,
+    // which this call's undo must leave as it was.
+    auto it = this->pool.find(name);
+    bool owned = it != this->pool.end() && it->second && it->second->value_type == "String";
+    for (size_t i = this->undo_log.size(); owned && this->activations > 0; --i) {
+        if (i == this->frame_start) owned = false;
+        else if (this->undo_log[i - 1].first == name) break;
+    }
+    if (owned) {
+        it->second->value = std::move(value);
+        return;
+    }
+    this->bind(name, std::make_shared<Variable>(name, std::move(value), "String", std::map<Symbol, std::shared_ptr<Variable>>{}, this));
+}
+
+std::shared_ptr<Variable> Parser::lookupVariable(std::string_view name) {
+    // Segments are looked up in the symbol table by view, so resolving a
+    // dotted path never allocates; a segment that was never interned cannot
+    // name any variable.
+    size_t dot = name.find('.');
+    Symbol key;
+    if (!Interner::get().find(name.substr(0, dot), key.id)) return nullptr;
+
+    // The head resolves in this pool first, then in enclosing parsers.
+    std::shared_ptr<Variable> current_var;
+    for (Parser* scope = this; scope && !current_var; scope = scope->parent) {
+        auto it = scope->pool.find(key);
+        if (it != scope->pool.end()) current_var = it->second;
+    }
+    if (!current_var) return nullptr;
+
+    // Dot access logic: walk children one segment at a time
+    while (dot != std::string_view::npos) {
+        if (current_var->value_type == "lazy_module") {
+            // First member access: import for real (this rebinds the name
+            // in the importing parser) and continue from the module.
+            Parser* owner = current_var->parser;
+            owner->importModule(current_var->name.str());
+            current_var = owner->pool[current_var->name];
         }
+        size_t next_dot = name.find('.', dot + 1);
+        std::string_view segment = name.substr(dot + 1, next_dot == std::string_view::npos ? std::string_view::npos : next_dot - dot - 1);
+        if (!Interner::get().find(segment, key.id)) return nullptr;
+        auto child = current_var->children.find(key);
+        if (child == current_var->children.end()) return nullptr;
+        current_var = child->second;
+        dot = next_dot;
     }
-    throw std::runtime_error("variable '" + name + "' not found");
+    return current_var;
 }
 
 ParsedMaterial Parser::parse() {
     return ParsedMaterial([this]() {
         this->parseSource();
+        this->preloadImports();
         this->execute();
     }, this);
 }
 
 void Parser::execute() {
-    for (auto& func : parsed_funcs) {
-        func();
+    this->returning = false;
+    for (auto& stmt : statements) {
+        stmt->execute(this);
+        if (this->returning) break;
     }
 }
 
 std::string Parser::parseSource() {
-    std::string content = file.read();
+    this->statements = this->compile(file.read());
+    return "";
+}
+
+std::vector<std::shared_ptr<Statement>> Parser::compile(const std::string& content) {
+    // Re-entrant: a loop body is compiled while its enclosing code is still
+    // being parsed, so the caller's in-progress state is set aside meanwhile.
+    auto outer_statements = std::move(this->statements);
+    auto outer_modes = std::move(this->mode_stack);
+    auto outer_char = this->char_obj;
+    this->statements.clear();
+    this->mode_stack.clear();
+
     for (size_t i = 0; i < content.length(); ++i) {
         std::string s(1, content[i]);
         this->char_obj = std::make_shared<Char>(s, i, this);
         this->parseChar();
     }
+    // Terminate a last line that has no newline (e.g. `fn f() { return 1 }`).
+    this->char_obj = std::make_shared<Char>("\n", content.length(), this);
+    this->parseChar();
     if (!mode_stack.empty() && std::any_cast<std::string>(mode_stack.back()["type"]) == "WAIT_BLOCK") {
         this->parseWaitBlock(true);
     }
     if (!mode_stack.empty()) {
         throw std::runtime_error("Unexpected end of file. Unterminated mode: " + std::any_cast<std::string>(mode_stack.back()["type"]));
     }
-    return "";
+    if (Parser::optimize_level >= 1) Optimizer::run(this->statements);
+
+    auto compiled = std::move(this->statements);
+    this->statements = std::move(outer_statements);
+    this->mode_stack = std::move(outer_modes);
+    this->char_obj = outer_char;
+    return compiled;
 }
 
 void Parser::parseChar(std::string match_value) {
@@ -174,11 +406,13 @@ void Parser::parseChar(std::string match_value) {
     else if (mode == "MLCOMMENT") parseMLComment();
     else if (mode == "ARTIFACT") parseArtifact();
     else if (mode == "INTEGER") parseInteger();
+    else if (mode == "INDEX_TARGET") parseIndexTarget();
     else if (mode == "ASSIGNMENT") parseAssignment();
     else if (mode == "FUNCTION_DEF") parseFunctionDef();
     else if (mode == "BLOCK") parseBlock();
     else if (mode == "WAIT_BLOCK") parseWaitBlock();
     else if (mode == "RETURN") parseReturn();
+    else if (mode == "LOOP") parseLoop();
 }
 
 void Parser::parseNull() {
@@ -214,21 +448,43 @@ void Parser::parseIdentifier() {
         mode_stack.back()["buffer"] = buf + s;
     } else if (s == "(") {
         std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
-        mode_stack.push_back({{"type", std::string("CALL")}, {"identifier", buf}, {"buffer", std::string("")}});
+        if (buf == "while") {
+            // `while(cond) {`: the parentheses are part of the condition
+            mode_stack.back() = {{"type", std::string("LOOP")}, {"keyword", buf}, {"phase", std::string("header")}, {"buffer", s}};
+            return;
+        }
+        mode_stack.push_back({{"type", std::string("CALL")}, {"identifier", Symbol(buf)}, {"buffer", std::string("")}});
         // pop IDENTIFIER
         // In python: self.mode_stack.pop(-2)
         // Here stack is ... IDENTIFIER, CALL. 
         // We want to remove IDENTIFIER (which is at -2).
         mode_stack.erase(mode_stack.end() - 2);
+    } else if (s == "[") {
+        // `name[key]... = value`
+        std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
+        mode_stack.back() = {{"type", std::string("INDEX_TARGET")}, {"buffer", buf + s}, {"nesting", 1}, {"quote", std::string("")}};
     } else if (isspace(s[0])) {
          std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
-         if (buf == "fn") {
+         bool memo = mode_stack.back().count("memo") > 0;
+         if (memo && buf.empty()) return; // more blanks after `memo`
+         if (memo && buf != "fn") throw std::runtime_error("Expected 'fn' after 'memo', got '" + buf + "'");
+         if (buf == "memo" && s != "\n") {
+             // `memo fn name(...) { ... }`: the FUNCTION_DEF mode inherits the flag
+             mode_stack.back()["memo"] = true;
+             mode_stack.back()["buffer"] = std::string("");
+         } else if (buf == "fn") {
              mode_stack.back()["type"] = std::string("FUNCTION_DEF");
              mode_stack.back()["phase"] = std::string("name");
              mode_stack.back()["buffer"] = std::string("");
          } else if (buf == "return") {
              mode_stack.back()["type"] = std::string("RETURN");
              mode_stack.back()["buffer"] = std::string("");
+             if (s == "\n") this->parseReturn(); // bare `return`
+         } else if (buf == "while" || buf == "for") {
+             mode_stack.back()["type"] = std::string("LOOP");
+             mode_stack.back()["keyword"] = buf;
+             mode_stack.back()["phase"] = std::string("header");
+             mode_stack.back()["buffer"] = std::string("");
          } else {
              // strict check assignment logic
              mode_stack.back()["type"] = std::string("CHECK_ASSIGNMENT");
@@ -236,6 +492,7 @@ void Parser::parseIdentifier() {
     } else if (s == "=") {
          // assignment
          std::string var_name = std::any_cast<std::string>(mode_stack.back()["buffer"]); // should strip?
+         if (var_name.empty() && mode_stack.back().count("memo")) var_name = "memo"; // `memo = ...`
          mode_stack.pop_back();
          mode_stack.push_back({{"type", std::string("ASSIGNMENT")}, {"name", var_name}, {"buffer", std::string("")}});
     } else {
@@ -277,149 +534,23 @@ void Parser::parseCall() {
               std::string buf = std::any_cast<std::string>(mode["buffer"]);
               mode["buffer"] = buf + s;
           } else {
-               std::string identifier = std::any_cast<std::string>(mode["identifier"]);
+               Symbol identifier = std::any_cast<Symbol>(mode["identifier"]);
                std::string arg_str = std::any_cast<std::string>(mode["buffer"]);
                mode_stack.pop_back(); 
                // poping CALL
 
-               // Split args
-               std::vector<std::any> args;
-               std::stringstream ss(arg_str);
-               std::string item;
-               // Basic split by comma (doesn't handle commas in strings/nested)
-               // TODO: Better split
-               while(std::getline(ss, item, ',')) {
-                    // trim
-                    item.erase(0, item.find_first_not_of(" \t"));
-                    item.erase(item.find_last_not_of(" \t") + 1);
-                    if(item.empty()) continue;
-
-                    // Check if pure math first (no quotes, no alpha except e/E if we supported sci notation, but let's stick to basic)
-                    if (item.find_first_not_of("0123456789+-*/%^. ()") == std::string::npos && 
-                        item.find_first_of("0123456789") != std::string::npos) { // Ensure at least one digit
-                         std::string cmd = "echo \"" + item + "\" | bc";
-                         std::string res = Builtins::systemreturn(cmd);
-                         if(!res.empty() && res.back() == '\n') res.pop_back();
-                         args.push_back(String(res));
-                         continue;
-                    }
-                    
-                    // Simple expression evaluator for concatenations
-                    std::string current_val;
-                    std::stringstream ss_plus(item);
-                    std::string part;
-                    bool first = true;
-                    
-                    while(std::getline(ss_plus, part, '+')) {
-                        // trim part
-                        part.erase(0, part.find_first_not_of(" \t"));
-                        part.erase(part.find_last_not_of(" \t") + 1);
-                        
-                        std::string part_val;
-                        if(part.empty()) continue;
-
-                        if(part.size() >= 2 && (part.front() == '"' || part.front() == '\'') && part.back() == part.front()) {
-                            part_val = part.substr(1, part.size()-2);
-                        } else if(isdigit(part[0]) || part[0] == '-') {
-                            // Math
-                            std::string cmd = "echo \"" + part + "\" | bc";
-                            std::string res = Builtins::systemreturn(cmd);
-                            if(!res.empty() && res.back() == '\n') res.pop_back();
-                            part_val = res;
-                        } else {
-                            // Function call check
-                            size_t open_paren = part.find('(');
-                            size_t close_paren = part.rfind(')');
-                            bool handled_call = false;
-                            
-                            if (open_paren != std::string::npos && close_paren == part.size() - 1 && open_paren < close_paren) {
-                                 std::string func_name = part.substr(0, open_paren);
-                                 bool valid_id = true;
-                                 for(char c : func_name) if(!isalnum(c) && c != '.' && c != '_') valid_id = false;
-                                 
-                                 if(valid_id) {
-                                     try {
-                                         auto func_var = this->findVariable(func_name);
-                                         std::string args_str = part.substr(open_paren + 1, close_paren - open_paren - 1);
-                                         std::vector<std::any> func_args;
-                                         std::stringstream ss_args(args_str);
-                                         std::string arg_item;
-                                         while(std::getline(ss_args, arg_item, ',')) {
-                                              arg_item.erase(0, arg_item.find_first_not_of(" \t"));
-                                              arg_item.erase(arg_item.find_last_not_of(" \t") + 1);
-                                              if(arg_item.empty()) continue;
-                                              if(isdigit(arg_item[0])) {
-                                                  func_args.push_back(String(arg_item)); 
-                                              } else {
-                                                  try {
-                                                      func_args.push_back(this->findVariable(arg_item)->value);
-                                                  } catch(...) {
-                                                      func_args.push_back(String(arg_item));
-                                                  }
-                                              }
-                                         }
-                                         std::any res = func_var->call(func_args);
-                                         if (res.type() == typeid(String)) part_val = static_cast<std::string>(std::any_cast<String>(res));
-                                         else if (res.type() == typeid(std::string)) part_val = std::any_cast<std::string>(res);
-                                         else if (res.type() != typeid(void)) part_val = ""; // Has value but unknown type
-                                         handled_call = true;
-                                     } catch(const ReturnSignal& sig) {
-                                         // Function returned via signal - extract value
-                                         if (sig.value.type() == typeid(String)) part_val = static_cast<std::string>(std::any_cast<String>(sig.value));
-                                         else if (sig.value.type() == typeid(std::string)) part_val = std::any_cast<std::string>(sig.value);
-                                         else part_val = "";
-                                         handled_call = true;
-                                     } catch(...) {}
-                                 }
-                            }
-                            
-                            if (!handled_call) {
-                                // Variable
-                                try {
-                                    auto v = this->findVariable(part);
-                                    if (v->value.type() == typeid(String)) part_val = static_cast<std::string>(std::any_cast<String>(v->value));
-                                    else if (v->value.type() == typeid(std::string)) part_val = std::any_cast<std::string>(v->value);
-                                    else part_val = "";
-                                } catch(...) {
-                                    part_val = part; // fallback
-                                }
-                            }
-                        }
-                        
-                        if(first) current_val = part_val;
-                        else {
-                            // Check if both are numeric for addition
-                            bool is_num1 = current_val.find_first_not_of("0123456789.-") == std::string::npos && 
-                                           current_val.find_first_of("0123456789") != std::string::npos;
-                            bool is_num2 = part_val.find_first_not_of("0123456789.-") == std::string::npos && 
-                                           part_val.find_first_of("0123456789") != std::string::npos;
-                            
-                            if (is_num1 && is_num2) {
-                                std::string cmd = "echo \"" + current_val + " + " + part_val + "\" | bc -l";
-                                std::string res = Builtins::systemreturn(cmd);
-                                if(!res.empty() && res.back() == '\n') res.pop_back();
-                                // bc -l can produce .123, normalize?
-                                current_val = res;
-                            } else {
-                                current_val += part_val;
-                            }
-                        }
-                        first = false;
-                    }
-                    args.push_back(String(current_val));
-               }
-
-               std::shared_ptr<Variable> var = this->findVariable(identifier);
-               if (var->children.count("__block_arg_index")) {
-                    std::map<std::string, std::any> next;
-                    next["type"] = std::string("WAIT_BLOCK");
-                    next["func"] = var;
-                    next["run_args"] = args;
-                    next["buffer"] = std::string("");
-                    mode_stack.push_back(next);
-               } else {
-                    var->call(args);
-               }
+               // Arguments are compiled once into expression trees here;
+               // nested calls and commas inside strings are handled by the parser.
+               auto call = std::make_shared<Expression>(Expression::Kind::Call);
+               call->name = identifier;
+               call->children = ExpressionParser(arg_str).parseArguments();
+
+               // A '{' after the call passes a block; WAIT_BLOCK decides and emits the statement.
+               std::map<std::string, std::any> next;
+               next["type"] = std::string("WAIT_BLOCK");
+               next["call"] = call;
+               next["buffer"] = std::string("");
+               mode_stack.push_back(next);
           }
      } else {
           std::string buf = std::any_cast<std::string>(mode["buffer"]);
@@ -430,7 +561,10 @@ void Parser::parseCheckAssignment() {
     std::string s = char_obj->string_val;
     if (isspace(s[0]) && s != "\n") return;
     if (s == "=") {
-        // ...
+        // `name = value`: same as `name=value`
+        std::string var_name = std::any_cast<std::string>(mode_stack.back()["buffer"]);
+        mode_stack.pop_back();
+        mode_stack.push_back({{"type", std::string("ASSIGNMENT")}, {"name", var_name}, {"buffer", std::string("")}});
     } else if (s == "\n") {
          throw std::runtime_error("Unexpected token/newline after identifier");
     } else {
@@ -456,13 +590,8 @@ void Parser::parseMath() {
          std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
          mode_stack.pop_back();
          
-         // Evaluate
-         std::string res = buf;
-         // Use bc for now
-         std::string cmd = "echo \"" + buf + "\" | bc -l"; // -l for float logic if needed
-         std::string out = Builtins::systemreturn(cmd);
-         if (!out.empty() && out.back() == '\n') out.pop_back();
-         res = out;
+         // Evaluate natively; the operands are all literals so this is a constant.
+         std::string res = Expression::toString(this->evaluate_expression(buf)).str();
          
          // Update parent buffer
          if (!mode_stack.empty()) {
@@ -484,37 +613,16 @@ void Parser::parseArtifact() {
           std::string module_name;
           std::stringstream ss(buf);
           ss >> action >> module_name;
+          std::string lazy_name;
+          ss >> lazy_name;
           
           if (action == "import") {
-              std::string path;
-              if (File(module_name + ".sv").getExists()) {
-                  path = module_name + ".sv";
-              } else if (File("reach/" + module_name + ".sv").getExists()) {
-                  path = "reach/" + module_name + ".sv";
-              } else if (File("../reach/" + module_name + ".sv").getExists()) {
-                  path = "../reach/" + module_name + ".sv";
-              } else if (File("servo/reach/" + module_name + ".sv").getExists()) {
-                   path = "servo/reach/" + module_name + ".sv";
-              } else {
-                  throw std::runtime_error("Module '" + module_name + "' not found locally or in reach.");
-              }
-              
-              Parser module_parser{File(path)};
-              module_parser.parse().execute(); // run it
-              
-              // Create module variable
-              // Filter defaults? Defaults are system, systemreturn, system_math, input.
-              std::map<std::string, std::shared_ptr<Variable>> module_members;
-              for(auto const& [key, val] : module_parser.pool) {
-                  if (key != "system" && key != "systemreturn" && key != "system_math" && key != "input") {
-                      module_members[key] = val;
-                  }
-              }
-              
-              // Variable type 'module', value could be anything or just use children
-              auto mod_var = std::make_shared<Variable>(module_name, 0, "module", module_members, this);
-              this->pool[module_name] = mod_var;
-
+              // Loading happens when the statement runs, keeping side effects in source order.
+              // `<import lazy name>` defers it to the first use of a member.
+              auto stmt = std::make_shared<Statement>(Statement::Kind::Import);
+              stmt->lazy = module_name == "lazy" && !lazy_name.empty();
+              stmt->name = Symbol(stmt->lazy ? lazy_name : module_name);
+              this->statements.push_back(stmt);
           } else {
                throw std::runtime_error("Unknown artifact action: " + action);
           }
@@ -541,40 +649,54 @@ void Parser::parseInteger() {
          this->parseChar();
     }
 }
+void Parser::parseIndexTarget() {
+    std::map<std::string, std::any>& mode = mode_stack.back();
+    std::string s = char_obj->string_val;
+    std::string buf = std::any_cast<std::string>(mode["buffer"]);
+    std::string quote = std::any_cast<std::string>(mode["quote"]);
+    int nesting = std::any_cast<int>(mode["nesting"]);
+
+    if (!quote.empty()) {
+        if (s == quote) mode["quote"] = std::string("");
+    } else if (s == "'" || s == "\"") {
+        mode["quote"] = s;
+    } else if (s == "[") {
+        mode["nesting"] = nesting + 1;
+    } else if (s == "]") {
+        mode["nesting"] = nesting - 1;
+    } else if (nesting == 0 && s == "=") {
+        mode_stack.back() = {{"type", std::string("ASSIGNMENT")}, {"name", std::string("")}, {"target", buf}, {"buffer", std::string("")}};
+        return;
+    } else if (s == "\n") {
+        throw std::runtime_error("Expected '=' after '" + buf + "'");
+    }
+    mode["buffer"] = buf + s;
+}
 void Parser::parseAssignment() {
      std::string s = char_obj->string_val;
      if (s == "\n") {
          std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
          std::string var_name = std::any_cast<std::string>(mode_stack.back()["name"]);
+         std::string target = mode_stack.back().count("target") ? std::any_cast<std::string>(mode_stack.back()["target"]) : "";
          mode_stack.pop_back();
 
         // remove leading/trailing whitespace
         buf.erase(0, buf.find_first_not_of(" \t"));
         buf.erase(buf.find_last_not_of(" \t") + 1);
 
-         if (!buf.empty()) {
-             std::any val;
-             if (buf.size() >=2 && (buf.front() == '"' || buf.front() == '\'')) {
-                  val = String(buf.substr(1, buf.size()-2));
-             } else if (isdigit(buf[0]) || buf[0] == '-') {
-                  std::string cmd = "echo \"" + buf + "\" | bc";
-                  std::string res = Builtins::systemreturn(cmd);
-                   // trim newline
-                   if(!res.empty() && res.back() == '\n') res.pop_back();
-                  val = String(res);
-             } else {
-                  try {
-                      auto v = this->findVariable(buf);
-                      val = v->value;
-                  } catch(...) {
-                      // Fallback to string if not found? Or error? Python evals. 
-                      // If fail, Python catches exception and does nothing?
-                      // Python: try link; except: print error; pass
-                      // We will assume string
-                      val = String(buf);
-                  }
-             }
-             this->pool[var_name] = std::make_shared<Variable>(var_name, val, "String", std::map<std::string, std::shared_ptr<Variable>>{}, this);
+         if (!target.empty()) {
+             if (buf.empty()) throw std::runtime_error("Expected a value after '" + target + " ='");
+             auto stmt = std::make_shared<Statement>(Statement::Kind::SetIndex);
+             stmt->target = ExpressionParser(target).parse();
+             if (stmt->target->kind != Expression::Kind::Index) throw std::runtime_error("Cannot assign to '" + target + "'");
+             stmt->expression = ExpressionParser(buf).parse();
+             this->statements.push_back(stmt);
+         } else if (!buf.empty()) {
+             // Compiled once; unknown bare names still evaluate to their own text.
+             auto stmt = std::make_shared<Statement>(Statement::Kind::Assign);
+             stmt->name = Symbol(var_name);
+             stmt->expression = ExpressionParser(buf).parse();
+             this->statements.push_back(stmt);
          }
      } else {
          std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
@@ -638,7 +760,7 @@ void Parser::parseFunctionDef() {
                  std::vector<std::string> args = std::any_cast<std::vector<std::string>>(mode["args"]);
                  std::string body = std::any_cast<std::string>(mode["buffer"]);
                  
-                 this->defineFunction(name, args, body);
+                 this->defineFunction(name, args, body, mode.count("memo") > 0);
                  mode_stack.pop_back();
              } else {
                  std::string buf = std::any_cast<std::string>(mode["buffer"]);
@@ -665,16 +787,13 @@ void Parser::parseBlock() {
             std::string block_code = std::any_cast<std::string>(mode["buffer"]);
             mode_stack.pop_back();
 
-            std::string anon_name = "__lambda_" + std::to_string(this->pool.size());
-            this->defineFunction(anon_name, {}, block_code);
-
-            if (!mode_stack.empty()) {
-                // Should check if parent has buffer
-                 try {
-                    std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
-                    mode_stack.back()["buffer"] = buf + anon_name;
-                 } catch(...) {}
-            }
+            // The block is compiled once per definition site into an anonymous
+            // function value that WAIT_BLOCK hands to the call; nothing is bound
+            // in the pool. A trivially empty block is the shared no-op.
+            std::shared_ptr<Variable> block;
+            if (Parser::optimize_level >= 1 && isBlank(block_code)) block = Parser::noopFunction();
+            else block = this->makeFunction("block", {}, block_code);
+            if (!mode_stack.empty()) mode_stack.back()["block"] = block;
         } else {
              std::string buf = std::any_cast<std::string>(mode["buffer"]);
              mode["buffer"] = buf + s;
@@ -686,67 +805,25 @@ void Parser::parseBlock() {
 }
 void Parser::parseWaitBlock(bool eof) {
     std::map<std::string, std::any>& mode = mode_stack.back();
-    std::string buffer = std::any_cast<std::string>(mode["buffer"]);
-    
-    // trim buffer
-    buffer.erase(0, buffer.find_first_not_of(" \t\n\r"));
-    buffer.erase(buffer.find_last_not_of(" \t\n\r") + 1);
-
-    if (!buffer.empty()) {
-        std::vector<std::any> final_args;
-        if (mode.count("run_args")) {
-             std::any ra = mode["run_args"];
-             if (ra.type() == typeid(std::vector<std::any>)) final_args = std::any_cast<std::vector<std::any>>(ra);
-             else final_args.push_back(ra);
-        }
-
-        std::shared_ptr<Variable> func_var = std::any_cast<std::shared_ptr<Variable>>(mode["func"]);
-        
-        int block_idx = -1;
-        if(func_var->children.count("__block_arg_index")) {
-            block_idx = std::any_cast<int>(func_var->children["__block_arg_index"]->value);
-        }
-        
-        if (block_idx != -1) {
-            try {
-                auto lambda_var = this->findVariable(buffer);
-                // Insert lambda into args at block_idx
-                if(static_cast<size_t>(block_idx) >= final_args.size()) {
-                     final_args.resize(block_idx + 1);
-                     final_args[block_idx] = lambda_var->value; // pass the function/any
-                } else {
-                     final_args.insert(final_args.begin() + block_idx, lambda_var->value);
-                }
-            } catch(...) {}
-        }
-        
-        mode_stack.pop_back();
-        func_var->call(final_args);
-
-        if (!eof) this->parseChar();
-        return;
-    }
 
-    if (!eof && isspace(char_obj->string_val[0])) return;
+    if (!mode.count("block")) {
+        if (!eof && isspace(char_obj->string_val[0])) return;
 
-    if (!eof && char_obj->string_val == "{") {
-        std::map<std::string, std::any> next_mode;
-        next_mode["type"] = std::string("BLOCK");
-        next_mode["buffer"] = std::string("");
-        next_mode["nesting"] = 1;
-        mode_stack.push_back(next_mode);
-        return;
+        if (!eof && char_obj->string_val == "{") {
+            std::map<std::string, std::any> next_mode;
+            next_mode["type"] = std::string("BLOCK");
+            next_mode["buffer"] = std::string("");
+            next_mode["nesting"] = 1;
+            mode_stack.push_back(next_mode);
+            return;
+        }
     }
 
+    auto stmt = std::make_shared<Statement>(Statement::Kind::Expression);
+    stmt->expression = std::any_cast<std::shared_ptr<Expression>>(mode["call"]);
+    if (mode.count("block")) stmt->block = std::any_cast<std::shared_ptr<Variable>>(mode["block"]);
     mode_stack.pop_back();
-    std::shared_ptr<Variable> func_var = std::any_cast<std::shared_ptr<Variable>>(mode["func"]);
-    std::vector<std::any> final_args;
-    if (mode.count("run_args")) {
-         std::any ra = mode["run_args"];
-         if (ra.type() == typeid(std::vector<std::any>)) final_args = std::any_cast<std::vector<std::any>>(ra);
-         else final_args.push_back(ra);
-    }
-    func_var->call(final_args);
+    this->statements.push_back(stmt);
 
     if (!eof) this->parseChar();
 }
@@ -760,30 +837,233 @@ void Parser::parseReturn() {
          buf.erase(0, buf.find_first_not_of(" \t"));
          buf.erase(buf.find_last_not_of(" \t") + 1);
 
-         std::any val;
-         if (!buf.empty()) {
-             if (buf.size() >=2 && (buf.front() == '"' || buf.front() == '\'')) {
-                  val = String(buf.substr(1, buf.size()-2));
-             } else if (isdigit(buf[0]) || buf[0] == '-') {
-                  std::string cmd = "echo \"" + buf + "\" | bc";
-                  std::string res = Builtins::systemreturn(cmd);
-                  if(!res.empty() && res.back() == '\n') res.pop_back();
-                  val = String(res);
-             } else {
-                  try {
-                       val = this->findVariable(buf)->value;
-                  } catch(...) {
-                       val = String(buf);
-                  }
-             }
-         }
-         throw ReturnSignal(val);
+         auto stmt = std::make_shared<Statement>(Statement::Kind::Return);
+         if (!buf.empty()) stmt->expression = ExpressionParser(buf).parse();
+         this->statements.push_back(stmt);
     } else {
          std::string buf = std::any_cast<std::string>(mode_stack.back()["buffer"]);
          mode_stack.back()["buffer"] = buf + s;
     }
 }
-void Parser::defineFunction(std::string name, std::vector<std::string> args, std::string body) {
+void Parser::parseLoop() {
+    std::map<std::string, std::any>& mode = mode_stack.back();
+    std::string s = char_obj->string_val;
+    std::string phase = std::any_cast<std::string>(mode["phase"]);
+
+    if (phase == "header") {
+        if (s == "{") {
+            mode["header"] = mode["buffer"];
+            mode["buffer"] = std::string("");
+            mode["phase"] = std::string("body");
+            mode["nesting"] = 1;
+        } else if (s == "\n") {
+            throw std::runtime_error("Expected '{' after " + std::any_cast<std::string>(mode["keyword"]) + " header");
+        } else {
+            mode["buffer"] = std::any_cast<std::string>(mode["buffer"]) + s;
+        }
+        return;
+    }
+
+    int nesting = std::any_cast<int>(mode["nesting"]);
+    if (s == "{") nesting++;
+    else if (s == "}") nesting--;
+    mode["nesting"] = nesting;
+    if (nesting > 0) {
+        mode["buffer"] = std::any_cast<std::string>(mode["buffer"]) + s;
+        return;
+    }
+
+    std::string keyword = std::any_cast<std::string>(mode["keyword"]);
+    std::string header = std::any_cast<std::string>(mode["header"]);
+    std::string body = std::any_cast<std::string>(mode["buffer"]);
+    mode_stack.pop_back();
+    header.erase(0, header.find_first_not_of(" \t"));
+    header.erase(header.find_last_not_of(" \t") + 1);
+
+    std::shared_ptr<Statement> stmt;
+    if (keyword == "while") {
+        if (header.empty()) throw std::runtime_error("while needs a condition");
+        stmt = std::make_shared<Statement>(Statement::Kind::While);
+        stmt->expression = ExpressionParser(header).parse();
+    } else {
+        // for <name> in range(<stop>) / range(<start>, <stop>[, <step>])
+        // for <name> in lines() / lines(<path>)  (no argument or "-": stdin)
+        // for <name> in <list or map expression>
+        std::stringstream ss(header);
+        std::string var_name, in;
+        ss >> var_name >> in;
+        std::string iterable;
+        std::getline(ss, iterable);
+        auto range = in == "in" ? ExpressionParser(iterable).parse() : nullptr;
+        bool is_call = range && range->kind == Expression::Kind::Call;
+        bool bad_range = is_call && range->name == Symbol("range") && (range->children.empty() || range->children.size() > 3);
+        bool bad_lines = is_call && range->name == Symbol("lines") && range->children.size() > 1;
+        if (var_name.empty() || !range || bad_range || bad_lines) {
+            throw std::runtime_error("Expected 'for <name> in range(...)', 'lines(...)' or a list or map, got 'for " + header + "'");
+        }
+        stmt = std::make_shared<Statement>(Statement::Kind::For);
+        stmt->name = Symbol(var_name);
+        stmt->expression = range;
+    }
+    // The body is compiled once, into this parser: it runs in the enclosing scope.
+    stmt->body = this->compile(body);
+    this->statements.push_back(stmt);
+}
+std::string Parser::findModule(const std::string& module_name) {
+    if (File(module_name + ".sv", true).getExists()) return module_name + ".sv";
+    if (File("reach/" + module_name + ".sv", true).getExists()) return "reach/" + module_name + ".sv";
+    if (File("../reach/" + module_name + ".sv", true).getExists()) return "../reach/" + module_name + ".sv";
+    if (File("servo/reach/" + module_name + ".sv", true).getExists()) return "servo/reach/" + module_name + ".sv";
+    return "";
+}
+
+void Parser::preloadImports() {
+    std::vector<std::string> names;
+    collectImports(this->statements, names);
+    if (names.empty()) return;
+
+    // Work list of module paths, grown by the workers as they find imports.
+    struct Job {
+        std::string key, path;
+        std::filesystem::file_time_type mtime;
+        std::shared_ptr<Parser> parser;
+    };
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs; // stable addresses
+    size_t next = 0, busy = 0;
+    std::set<std::string> seen;
+
+    // Queues the modules not already compiled and current in this thread's cache.
+    auto enqueue = [&](const std::vector<std::string>& modules) {
+        for (auto& name : modules) {
+            std::string path = findModule(name);
+            if (path.empty()) continue; // importModule reports it when it runs
+            std::error_code ec;
+            std::string key = std::filesystem::absolute(path, ec).string();
+            if (!seen.insert(key).second) continue;
+            auto mtime = std::filesystem::last_write_time(path, ec);
+            if (ec) continue;
+            jobs.push_back({key, path, mtime, nullptr});
+        }
+    };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [key, cached] : module_cache) seen.insert(key); // reused or reloaded by importModule
+        enqueue(names);
+    }
+    if (jobs.empty()) return;
+
+    auto work = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return next < jobs.size() || busy == 0; });
+            if (next == jobs.size()) break; // nothing queued and nobody can queue more
+            Job& job = jobs[next++];
+            busy++;
+            lock.unlock();
+            // Compiling has no side effects; a module that fails to compile is
+            // left for importModule, which reports the error in source order.
+            auto parser = std::make_shared<Parser>(File(job.path));
+            std::vector<std::string> found;
+            try {
+                parser->parseSource();
+                collectImports(parser->statements, found);
+            } catch (const std::exception&) {
+                parser = nullptr;
+            }
+            lock.lock();
+            job.parser = std::move(parser);
+            enqueue(found);
+            busy--;
+            wake.notify_all();
+        }
+    };
+    // Helpers only pay off with a second CPU to run them.
+    unsigned threads = std::thread::hardware_concurrency() > 1 ? Parser::load_threads : 1;
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < threads; ++i) helpers.emplace_back(work);
+    work();
+    for (auto& t : helpers) t.join();
+
+    for (auto& job : jobs) {
+        if (!job.parser) continue;
+        auto pool = job.parser->pool;
+        module_cache[job.key] = CachedModule{std::move(job.parser), job.mtime, true, std::move(pool), 0};
+    }
+}
+
+std::vector<std::string> Parser::loadedModules() {
+    std::vector<std::string> paths;
+    for (auto& [key, cached] : module_cache) paths.push_back(key);
+    return paths;
+}
+
+void Parser::beginScript() {
+    script_run++;
+}
+
+void Parser::restorePool(const std::map<Symbol, std::shared_ptr<Variable>>& compiled) {
+    for (auto& [key, var] : pool) key.touch(); // inline caches may hold the old bindings
+    pool = compiled;
+}
+
+void Parser::bindLazyModule(const std::string& module_name) {
+    this->bind(module_name, std::make_shared<Variable>(module_name, String(module_name), "lazy_module", std::map<Symbol, std::shared_ptr<Variable>>{}, this));
+}
+
+void Parser::importModule(const std::string& module_name) {
+    std::string path = findModule(module_name);
+    if (path.empty()) throw std::runtime_error("Module '" + module_name + "' not found locally or in reach.");
+
+    // The module parser must outlive this call: its functions resolve names through it.
+    // Compiled modules are cached per thread (a module's functions mutate their
+    // body parsers while running) and recompiled when the file changes, so later
+    // scripts on the same thread import without re-parsing. A module runs once
+    // per script run, so scripts never see each other's module globals.
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    auto& cached = module_cache[std::filesystem::absolute(path, ec).string()]; // cwd may change between scripts
+    if (!cached.parser || ec || cached.mtime != mtime || (!cached.compiled && cached.run != script_run)) {
+        cached = CachedModule{std::make_shared<Parser>(File(path)), mtime, false, {}, 0};
+    }
+    if (cached.run != script_run) {
+        cached.run = script_run; // first, so an import cycle does not run it twice
+        Parser* module = cached.parser.get();
+        CachedModule* entry = &cached; // map nodes are stable
+        ParsedMaterial([module, entry]() {
+            if (!entry->compiled) {
+                module->parseSource();
+                entry->pool = module->pool;
+                entry->compiled = true;
+            } else {
+                module->restorePool(entry->pool);
+            }
+            module->preloadImports();
+            module->execute();
+        }, module).execute();
+    }
+    auto module_parser = cached.parser;
+
+    // Create module variable; builtins the module did not rebind are left out.
+    const auto& defaults = Parser::builtins();
+    std::map<Symbol, std::shared_ptr<Variable>> module_members;
+    for(auto const& [key, val] : module_parser->pool) {
+        auto it = defaults.find(key);
+        if (it == defaults.end() || it->second != val) {
+            module_members[key] = val;
+        }
+    }
+
+    // Variable type 'module'; its value keeps the module parser alive
+    auto mod_var = std::make_shared<Variable>(module_name, module_parser, "module", module_members, this);
+    this->bind(module_name, mod_var);
+}
+void Parser::defineFunction(std::string name, std::vector<std::string> args, std::string body, bool memo) {
+    this->bind(name, this->makeFunction(name, std::move(args), std::move(body), memo));
+}
+
+std::shared_ptr<Variable> Parser::makeFunction(std::string name, std::vector<std::string> args, std::string body, bool memo) {
     std::vector<std::string> clean_args;
     int block_arg_idx = -1;
     for(size_t i=0; i<args.size(); ++i) {
@@ -796,37 +1076,104 @@ void Parser::defineFunction(std::string name, std::vector<std::string> args, std
         }
     }
 
-    auto func_impl = [this, body, clean_args](std::vector<std::any> call_args) -> std::any {
-         // Flatten args if single tuple/vector passed? 
-         // Python impl checks for tuple.
-         // C++ call convention is vector<any>.
-         
-         Parser func_parser(File("virtual", body));
-         // func_parser.pool = this->pool;
-         
-         for(size_t i=0; i<clean_args.size(); ++i) {
-             if(i < call_args.size()) {
-                 func_parser.pool[clean_args[i]] = std::make_shared<Variable>(clean_args[i], call_args[i], "arg", std::map<std::string, std::shared_ptr<Variable>>{}, &func_parser);
-             } else {
-                 // Default to empty string
-                 func_parser.pool[clean_args[i]] = std::make_shared<Variable>(clean_args[i], String(""), "arg", std::map<std::string, std::shared_ptr<Variable>>{}, &func_parser);
-             }
+    // The body is compiled once, here; each call only binds arguments and runs it.
+    // Lookups that miss the body's own pool continue in this (the defining) parser.
+    auto body_parser = std::make_shared<Parser>(File("virtual", body), this);
+    body_parser->parseSource();
+
+    if (Parser::optimize_level >= 1 && body_parser->statements.empty()) {
+        // Nothing to run: bind the shared no-op and drop the body parser.
+        auto var = std::make_shared<Variable>(name, Parser::noopFunction()->value, "func", std::map<Symbol, std::shared_ptr<Variable>>{}, this);
+        if(block_arg_idx != -1) {
+            var->children["__block_arg_index"] = std::make_shared<Variable>("__block_arg_index", block_arg_idx, "int", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+        }
+        return var;
+    }
+
+    // Parameters get one slot Variable each, created here and reused by every
+    // call: a call moves the outer activation's values aside, writes its own
+    // arguments into the slots, and puts the old values back on exit.
+    std::vector<std::shared_ptr<Variable>> params;
+    for (auto& arg : clean_args) {
+        params.push_back(std::make_shared<Variable>(arg, String(""), "arg", std::map<Symbol, std::shared_ptr<Variable>>{}, body_parser.get()));
+        body_parser->bind(arg, params.back());
+    }
+
+    // Tiering state for --jit; functions taking a block never qualify.
+    std::vector<Symbol> param_names(clean_args.begin(), clean_args.end());
+    auto jit = std::make_shared<JitFunction>(body_parser.get(), param_names);
+    if (block_arg_idx != -1) jit->state = JitFunction::State::Failed;
+    jit->memo = memo;
+
+    Symbol func_name(name);
+    auto func_impl = [body_parser, params, jit, func_name](Args call_args, std::any& result) {
+         if (Jit::enabled && jit->run(call_args, result)) return;
+         Parser& frame = *body_parser;
+         if (sys_stack.size() >= max_depth || NativeStack::exhausted()) {
+             throw std::runtime_error("maximum call depth exceeded in '" + func_name.str() + "' at depth "
+                 + std::to_string(sys_stack.size()) + " (limit " + std::to_string(max_depth) + ", see --max-depth)");
          }
-         
-         try {
-             ParsedMaterial mat = func_parser.parse();
-             mat.run(); // or execute()? Header says execute()
-         } catch (const ReturnSignal& sig) {
-             return sig.value;
+         ArgFrame saved(params.size());
+         for (size_t i = 0; i < params.size(); ++i) {
+             saved[i] = std::move(params[i]->value);
+             if (i < call_args.size()) params[i]->value = call_args[i];
+             else params[i]->value = String(); // Default to empty string
          }
-         return std::any();
+
+         // Undo everything this call bound (locals, rebound parameters) and
+         // restore the parameter values, also when the body throws.
+         struct Activation {
+             Parser& frame;
+             const std::vector<std::shared_ptr<Variable>>& params;
+             ArgFrame& saved;
+             size_t mark;
+             size_t outer_start;
+             ~Activation() {
+                 while (frame.undo_log.size() > mark) {
+                     auto& [key, old] = frame.undo_log.back();
+                     key.touch();
+                     if (old) frame.pool[key] = std::move(old);
+                     else frame.pool.erase(key);
+                     frame.undo_log.pop_back();
+                 }
+                 for (size_t i = 0; i < params.size(); ++i) params[i]->value = std::move(saved[i]);
+                 frame.frame_start = outer_start;
+                 frame.activations--;
+                 frame.returning = false;
+                 sys_stack.pop_back();
+             }
+         } activation{frame, params, saved, frame.undo_log.size(), frame.frame_start};
+         frame.frame_start = frame.undo_log.size();
+         frame.activations++;
+         sys_stack.emplace_back(func_name, Symbol("func"), &frame);
+
+         frame.execute();
+         if (frame.tail_callee) result = TailCall{&frame}; // run by Variable::invoke after we unwind
+         else if (frame.returning) result = std::move(frame.return_value);
     };
     
-    auto var = std::make_shared<Variable>(name, std::function<std::any(std::vector<std::any>)>(func_impl), "func", std::map<std::string, std::shared_ptr<Variable>>{}, this);
+    Callable callable(func_impl);
+    if (memo) {
+        // `memo fn`: results keyed by argument values. Tail calls are run to
+        // completion first (Variable::invoke) so only final values are cached.
+        auto table = std::make_shared<Memo>(Symbol(name));
+        callable = [inner = std::move(callable), table](Args call_args, std::any& result) {
+            if (table->lookup(call_args, result)) return;
+            Variable::invoke(inner, call_args, result);
+            table->store(call_args, result);
+        };
+    }
+
+    auto var = std::make_shared<Variable>(name, std::move(callable), "func", std::map<Symbol, std::shared_ptr<Variable>>{}, this);
     if(block_arg_idx != -1) {
-        var->children["__block_arg_index"] = std::make_shared<Variable>("__block_arg_index", block_arg_idx, "int", std::map<std::string, std::shared_ptr<Variable>>{}, nullptr);
+        var->children["__block_arg_index"] = std::make_shared<Variable>("__block_arg_index", block_arg_idx, "int", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
     }
-    this->pool[name] = var;
+    var->children["__jit"] = std::make_shared<Variable>("__jit", jit, "jit", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+    return var;
+}
+
+std::any Parser::evaluate_expression(std::string expr) {
+    return ExpressionParser(expr).parse()->evaluate(this);
 }
 
 }
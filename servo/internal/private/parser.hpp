@@ -13,36 +13,62 @@
 #include "../public/layer.hpp"
 #include "../public/variable.hpp"
 #include "../public/parsedmaterial.hpp"
+#include "../public/expression.hpp"
+#include "../public/statement.hpp"
 #include "../public/string.hpp"
+#include "../public/symbol.hpp"
 #include "../public/safe.hpp"
 #include "builtins.hpp"
 
 namespace servo {
 
-struct ReturnSignal : public std::exception {
-    std::any value;
-    ReturnSignal(std::any v) : value(v) {}
-};
-
-
 class Parser {
 public:
     File file;
+    Parser* parent; // lexically enclosing parser (function bodies, blocks); nullptr for files
     // Char* char_obj; // using pointer or optional
     std::shared_ptr<Char> char_obj;
     std::vector<std::map<std::string, std::any>> mode_stack;
-    std::vector<Layer> sys_stack;
-    std::vector<std::function<void()>> parsed_funcs;
-    std::map<std::string, std::shared_ptr<Variable>> pool;
+    // Call stack of the running thread: one Layer per active user function call.
+    static thread_local std::vector<Layer> sys_stack;
+    std::vector<std::shared_ptr<Statement>> statements; // compiled form, run by execute()
+    std::map<Symbol, std::shared_ptr<Variable>> pool;
+
+    // Set by a return statement; execute() stops and the caller takes the value.
+    bool returning = false;
+    std::any return_value;
+    // Pending tail call left by `return f(...)` inside a function body.
+    std::shared_ptr<Variable> tail_callee;
+    std::vector<std::any> tail_args;
+    bool tail_boolean = false; // the result passes through && / ||
 
-    Parser(File file);
+    // Function bodies: while a call is active (activations > 0), bind() logs the
+    // binding it replaces so the call can undo its locals on exit.
+    int activations = 0;
+    std::vector<std::pair<Symbol, std::shared_ptr<Variable>>> undo_log;
+    size_t frame_start = 0; // undo_log size when the innermost active call began
+
+    static int optimize_level; // -O0 / -O1 (default)
+    static unsigned load_threads; // threads compiling imported modules ahead of execution
+    static size_t max_depth;   // --max-depth: deepest servo call stack before an error
+    static bool lazy_imports;  // --lazy-imports: every import behaves as `<import lazy ...>`
+
+    Parser(File file, Parser* parent = nullptr);
 
     std::string getLastModeStackType();
     std::string wrap_strings(std::string expr);
-    std::shared_ptr<Variable> findVariable(std::string name);
+    std::shared_ptr<Variable> findVariable(std::string_view name);
+    std::shared_ptr<Variable> lookupVariable(std::string_view name); // nullptr when missing
+    // All pool writes go through bind() so inline caches see the rebinding.
+    void bind(Symbol name, std::shared_ptr<Variable> var);
+    // `name = value`: updates a plain variable this scope already owns in
+    // place (no rebinding, so caches stay valid), otherwise binds a new one.
+    void assign(Symbol name, std::any value);
     ParsedMaterial parse();
     void execute();
     std::string parseSource();
+    // Compile code into a statement list without running it (source files, loop bodies).
+    std::vector<std::shared_ptr<Statement>> compile(const std::string& code);
     void parseChar(std::string match_value = "");
     
     // Parsing methods
@@ -56,14 +82,38 @@ public:
     void parseMLComment();
     void parseArtifact();
     void parseInteger();
+    void parseIndexTarget();
     void parseAssignment();
     void parseFunctionDef();
     void parseBlock();
     void parseWaitBlock(bool eof=false);
     void parseReturn();
+    void parseLoop();
 
-    void defineFunction(std::string name, std::vector<std::string> args, std::string body);
+    void defineFunction(std::string name, std::vector<std::string> args, std::string body, bool memo = false);
+    // Compiles a function value without binding it (block arguments are anonymous).
+    std::shared_ptr<Variable> makeFunction(std::string name, std::vector<std::string> args, std::string body, bool memo = false);
+    void importModule(const std::string& module_name);
+    // Binds a stub that imports the module into this parser when one of its
+    // members is first resolved (see lookupVariable).
+    void bindLazyModule(const std::string& module_name);
+    // Reads and compiles every module reachable through this parser's import
+    // statements in parallel; they still run only when their import executes.
+    void preloadImports();
+    static std::string findModule(const std::string& module_name); // "" when missing
+    // Starts a new script run on this thread: each cached module runs again,
+    // with fresh globals, at its first import (changed files are re-read then).
+    static void beginScript();
+    // The files of every module in this thread's cache, for --watch.
+    static std::vector<std::string> loadedModules();
+    // Back to a pool saved right after compiling, before running again.
+    void restorePool(const std::map<Symbol, std::shared_ptr<Variable>>& compiled);
     
+    static std::shared_ptr<Variable> noopFunction();
+    // system, systemreturn, system_math, input: the initial contents of every pool.
+    static const std::map<Symbol, std::shared_ptr<Variable>>& builtins();
+    static bool isBlank(const std::string& code);
+
     // Helper for eval
     std::any evaluate_expression(std::string expr);
 };
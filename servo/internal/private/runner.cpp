@@ -0,0 +1,206 @@
+#include "runner.hpp"
+#include "emitter.hpp"
+#include "parser.hpp"
+#include "stack.hpp"
+#include "../public/safe.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace servo {
+
+int Runner::runFile(const std::string& path, const std::vector<std::string>& args) {
+    servo::File f(path, true);
+    if (f.getType() != "file") {
+         std::cerr << "\033[1m[servo@spp]\033[0;91m tried to run servo file that is a directory or does not exist:\n        - " << f.getPath() << "\033[0m" << std::endl;
+         return 1;
+    }
+    f.read();
+
+    Parser p(f);
+    return run(p, args);
+}
+
+int Runner::runSource(const std::string& source, const std::vector<std::string>& args) {
+    Parser p(File("<inline>", source));
+    return run(p, args);
+}
+
+int Runner::emitCpp(const std::string& path) {
+    servo::File f(path, true);
+    if (f.getType() != "file") {
+         std::cerr << "\033[1m[servo@spp]\033[0;91m tried to compile servo file that is a directory or does not exist:\n        - " << f.getPath() << "\033[0m" << std::endl;
+         return 1;
+    }
+    f.read();
+
+    Parser p(f);
+    std::string code;
+    try {
+        NativeStack::run([&]() {
+            Safe::call([&]() {
+                p.parseSource();
+                code = CppEmitter::emit(p, f.getPath());
+            }, "parsed_execution");
+        });
+    } catch (const std::exception& e) {
+        // Safe::call has already reported the error
+        return 1;
+    }
+    std::cout << code;
+    return 0;
+}
+
+int Runner::run(Parser& p, const std::vector<std::string>& args) {
+    Parser::beginScript();
+    auto args_var = std::make_shared<Variable>("args", String(), "module", std::map<Symbol, std::shared_ptr<Variable>>{}, &p);
+    args_var->children["count"] = std::make_shared<Variable>("count", String(static_cast<int>(args.size())), "int", std::map<Symbol, std::shared_ptr<Variable>>{}, &p);
+    for (size_t i = 0; i < args.size(); ++i) {
+        std::string key = std::to_string(i);
+        args_var->children[key] = std::make_shared<Variable>(key, String(args[i]), "String", std::map<Symbol, std::shared_ptr<Variable>>{}, &p);
+    }
+    p.bind("args", args_var);
+
+    int status = 0;
+    try {
+        NativeStack::run([&p]() { p.parse().execute(); });
+    } catch (const std::exception& e) {
+        // Safe::call has already reported the error
+        status = 1;
+    }
+    Output::flushAll();
+    return status;
+}
+
+int Runner::watch(const std::string& path, const std::vector<std::string>& args) {
+    using Clock = std::chrono::steady_clock;
+    namespace fs = std::filesystem;
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "\033[1m[servo@spp]\033[0;91m --watch: inotify unavailable: " << std::strerror(errno) << "\033[0m" << std::endl;
+        return 1;
+    }
+
+    // Directories are watched rather than files, so editors that save by
+    // renaming a new file over the old one are seen too.
+    std::map<int, fs::path> dirs; // watch descriptor -> directory
+    std::set<fs::path> files;     // the script and its modules
+    auto track = [&](const std::string& file) {
+        std::error_code ec;
+        fs::path full = fs::absolute(file, ec).lexically_normal();
+        if (ec || !files.insert(full).second) return;
+        int wd = inotify_add_watch(fd, full.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd >= 0) dirs[wd] = full.parent_path();
+    };
+
+    int status = runFile(path, args);
+    std::string changed;
+    alignas(inotify_event) char buffer[64 * 1024];
+    while (true) {
+        track(path);
+        for (auto& module : Parser::loadedModules()) track(module);
+
+        // Block for a change to a tracked file, then let a burst of writes
+        // (one save can be several events) settle for a few milliseconds.
+        changed.clear();
+        int timeout = -1;
+        while (true) {
+            pollfd pfd{fd, POLLIN, 0};
+            int ready = poll(&pfd, 1, timeout);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready <= 0) break;
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n <= 0) break;
+            for (char* p = buffer; p < buffer + n;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                auto dir = dirs.find(event->wd);
+                if (dir == dirs.end() || event->len == 0) continue;
+                fs::path file = dir->second / event->name;
+                if (files.count(file)) {
+                    changed = file.filename().string();
+                    timeout = 5;
+                }
+            }
+        }
+
+        auto start = Clock::now();
+        status = runFile(path, args);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::cerr << "\033[1m[servo@spp]\033[0m watch: " << changed << " changed, re-ran in " << ms << " ms (status " << status << ")" << std::endl;
+    }
+    return status;
+}
+
+std::vector<std::string> Runner::readList(const std::string& list_path) {
+    std::ifstream file;
+    if (list_path != "-") {
+        file.open(list_path);
+        if (!file) throw std::runtime_error("cannot open batch list '" + list_path + "'");
+    }
+    std::istream& in = list_path == "-" ? std::cin : file;
+
+    // One path per line; blank lines and # comments are skipped.
+    std::vector<std::string> paths;
+    std::string line;
+    while (std::getline(in, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty() && line[0] != '#') paths.push_back(line);
+    }
+    return paths;
+}
+
+int Runner::runBatch(const std::string& list_path, int jobs) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::string> paths;
+    try {
+        paths = readList(list_path);
+    } catch (const std::exception& e) {
+        std::cerr << "\033[1m[servo@spp]\033[0;91m " << e.what() << "\033[0m" << std::endl;
+        return 1;
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> failed{0};
+    std::mutex report;
+    auto batch_start = Clock::now();
+
+    // Workers pull the next unclaimed script; the module cache is per thread,
+    // so a worker re-uses the modules earlier scripts on it compiled (each
+    // script still runs them afresh, see Parser::beginScript).
+    auto worker = [&]() {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            auto start = Clock::now();
+            int status = runFile(paths[i]);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (status != 0) failed++;
+
+            std::lock_guard<std::mutex> guard(report);
+            std::cerr << status << "\t" << ms << "\t" << paths[i] << std::endl;
+        }
+    };
+
+    if (jobs < 1) jobs = 1;
+    std::vector<std::thread> threads;
+    for (int j = 1; j < jobs; ++j) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+
+    double total = std::chrono::duration<double, std::milli>(Clock::now() - batch_start).count();
+    std::cerr << "\033[1m[servo@spp]\033[0m batch: " << paths.size() << " scripts, " << failed.load()
+              << " failed, " << total << " ms on " << jobs << (jobs == 1 ? " thread" : " threads") << std::endl;
+    return failed.load() == 0 ? 0 : 1;
+}
+
+}
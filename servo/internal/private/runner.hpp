@@ -0,0 +1,43 @@
+#ifndef SERVO_INTERNAL_PRIVATE_RUNNER_HPP
+#define SERVO_INTERNAL_PRIVATE_RUNNER_HPP
+
+#include <string>
+#include <vector>
+
+namespace servo {
+
+class Parser;
+
+// Entry points of servocomp: one script, or many in one process.
+class Runner {
+public:
+    // Parse and run one script in a fresh Parser; returns its exit status.
+    // `args` are visible to the script as args.count and args.0, args.1, ...
+    static int runFile(const std::string& path, const std::vector<std::string>& args = {});
+    static int runSource(const std::string& source, const std::vector<std::string>& args = {});
+
+    // Run every script listed in `list_path` (one per line, "-" for stdin) on
+    // `jobs` worker threads. Builtins are shared and each worker keeps its
+    // imported modules warm; every script still gets its own globals.
+    // Writes "<status>\t<ms>\t<path>" per script to stderr, then a summary.
+    static int runBatch(const std::string& list_path, int jobs);
+
+    // --watch: run the script, then re-run it from the top whenever it or a
+    // module it imported changes on disk (inotify on their directories).
+    // Unchanged modules keep their compiled form and only run again; the
+    // latency of each re-run is reported on stderr. Runs until killed.
+    static int watch(const std::string& path, const std::vector<std::string>& args = {});
+
+    // --emit-cpp: parse the script without running it and write the C++
+    // translation of it to stdout (see CppEmitter); returns the exit status.
+    static int emitCpp(const std::string& path);
+
+    static std::vector<std::string> readList(const std::string& list_path);
+
+private:
+    static int run(Parser& parser, const std::vector<std::string>& args);
+};
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+#include "server.hpp"
+#include "runner.hpp"
+#include "../public/linereader.hpp"
+#include "../public/output.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace servo {
+
+namespace {
+
+constexpr int passed_fds = 3; // stdin, stdout, stderr
+constexpr uint32_t max_payload = 64u << 20; // cwd, script or inline source, and args
+
+sockaddr_un address(const std::string& socket_path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("socket path too long: " + socket_path);
+    std::strcpy(addr.sun_path, socket_path.c_str());
+    return addr;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+void fail(const std::string& message) {
+    std::cerr << "\033[1m[servo@spp]\033[0;91m " << message << "\033[0m" << std::endl;
+}
+
+// Both ends pass their descriptors to the other, so each must be our own user.
+bool sameUser(int connection) {
+    ucred peer{};
+    socklen_t size = sizeof(peer);
+    return getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &peer, &size) == 0 && peer.uid == getuid();
+}
+
+}
+
+std::string Server::defaultSocket() {
+    if (const char* env = std::getenv("SERVO_SOCKET")) return env;
+    // The runtime directory is private to the user; /tmp is only a fallback.
+    if (const char* dir = std::getenv("XDG_RUNTIME_DIR"); dir && *dir) return std::string(dir) + "/servocomp.sock";
+    return "/tmp/servocomp-" + std::to_string(getuid()) + ".sock";
+}
+
+int Server::serve(const std::string& socket_path, int workers) {
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        fail(std::string("socket: ") + std::strerror(errno));
+        return 1;
+    }
+    sockaddr_un addr;
+    try {
+        addr = address(socket_path);
+    } catch (const std::exception& e) {
+        fail(e.what());
+        return 1;
+    }
+    // Replace a stale socket left by a previous server, but never a regular file.
+    struct stat st;
+    if (lstat(socket_path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) unlink(socket_path.c_str());
+    // Created owner-only: a chmod() after bind() would leave a window open.
+    mode_t mask = umask(077);
+    int bound = bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    umask(mask);
+    if (bound < 0 || listen(listener, 128) < 0) {
+        fail("cannot listen on " + socket_path + ": " + std::strerror(errno));
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    if (workers < 1) workers = 1;
+    auto spawn = [listener]() -> pid_t {
+        pid_t pid = fork();
+        if (pid == 0) {
+            prctl(PR_SET_PDEATHSIG, SIGTERM); // do not outlive the server
+            work(listener);
+            _exit(0);
+        }
+        return pid;
+    };
+    for (int i = 0; i < workers; ++i) spawn();
+    std::cerr << "\033[1m[servo@spp]\033[0m serving on " << socket_path << " with " << workers << " workers" << std::endl;
+
+    // Supervise: a worker that dies (e.g. a script crashed it) is replaced.
+    while (true) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        fail("worker " + std::to_string(pid) + " exited, restarting");
+        spawn();
+    }
+    return 0;
+}
+
+void Server::work(int listener) {
+    while (true) {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            _exit(1);
+        }
+        if (sameUser(connection)) handle(connection);
+        close(connection);
+    }
+}
+
+void Server::handle(int connection) {
+    // Header: payload length, with the client's descriptors attached.
+    uint32_t length = 0;
+    char control[CMSG_SPACE(sizeof(int) * passed_fds)] = {};
+    iovec iov{&length, sizeof(length)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(connection, &msg, MSG_WAITALL) != sizeof(length)) return;
+
+    int fds[passed_fds] = {-1, -1, -1};
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS
+        && cmsg->cmsg_len == CMSG_LEN(sizeof(int) * passed_fds)) {
+        std::memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    }
+    auto close_fds = [&fds]() {
+        for (int& fd : fds) if (fd >= 0) { close(fd); fd = -1; }
+    };
+
+    // Payload: NUL-terminated fields cwd, kind ("path" / "source"), script, args...
+    if (fds[0] < 0 || length > max_payload) {
+        close_fds();
+        return;
+    }
+    std::string payload(length, '\0');
+    if (!readAll(connection, payload.data(), length)) {
+        close_fds();
+        return;
+    }
+    std::vector<std::string> fields;
+    for (size_t start = 0; start < payload.size();) {
+        size_t end = payload.find('\0', start);
+        if (end == std::string::npos) end = payload.size();
+        fields.push_back(payload.substr(start, end - start));
+        start = end + 1;
+    }
+
+    int status = 1;
+    char saved_cwd[4096];
+    bool have_cwd = getcwd(saved_cwd, sizeof(saved_cwd)) != nullptr;
+
+    Output::flushAll();
+    std::cout.flush();
+    std::fflush(nullptr);
+    int saved[passed_fds];
+    for (int i = 0; i < passed_fds; ++i) {
+        saved[i] = dup(i);
+        dup2(fds[i], i);
+    }
+    LineReader::standardInput().reset(); // nothing buffered from the previous client
+    close_fds();
+
+    if (fields.size() < 3) {
+        fail("malformed request");
+    } else if (chdir(fields[0].c_str()) < 0) {
+        fail("cannot enter " + fields[0] + ": " + std::strerror(errno));
+    } else {
+        std::vector<std::string> args(fields.begin() + 3, fields.end());
+        status = fields[1] == "source" ? Runner::runSource(fields[2], args) : Runner::runFile(fields[2], args);
+    }
+
+    Output::flushAll();
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    for (int i = 0; i < passed_fds; ++i) {
+        dup2(saved[i], i);
+        close(saved[i]);
+    }
+    if (have_cwd && chdir(saved_cwd) < 0) _exit(1);
+
+    int32_t reply = status;
+    writeAll(connection, reinterpret_cast<const char*>(&reply), sizeof(reply));
+}
+
+int Server::client(const std::string& socket_path, const Request& request) {
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    try {
+        addr = address(socket_path);
+    } catch (const std::exception& e) {
+        fail(e.what());
+        return 1;
+    }
+    if (connection < 0 || connect(connection, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        fail("no servocomp server on " + socket_path + ": " + std::strerror(errno));
+        return 1;
+    }
+    if (!sameUser(connection)) {
+        fail("servocomp server on " + socket_path + " belongs to another user");
+        close(connection);
+        return 1;
+    }
+
+    std::string payload = request.cwd + '\0' + (request.inline_source ? "source" : "path") + '\0' + request.script + '\0';
+    for (auto& arg : request.args) payload += arg + '\0';
+    if (payload.size() > max_payload) {
+        fail("request too large for the servocomp server");
+        close(connection);
+        return 1;
+    }
+    uint32_t length = static_cast<uint32_t>(payload.size());
+
+    int fds[passed_fds] = {0, 1, 2};
+    char control[CMSG_SPACE(sizeof(fds))] = {};
+    iovec iov{&length, sizeof(length)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    int32_t status = 1;
+    if (sendmsg(connection, &msg, 0) != sizeof(length) || !writeAll(connection, payload.data(), payload.size())) {
+        fail("cannot send request to " + socket_path + ": " + std::strerror(errno));
+    } else if (!readAll(connection, reinterpret_cast<char*>(&status), sizeof(status))) {
+        fail("servocomp server closed the connection without a result");
+        status = 1;
+    }
+    close(connection);
+    return status;
+}
+
+}
@@ -0,0 +1,43 @@
+#ifndef SERVO_INTERNAL_PRIVATE_SERVER_HPP
+#define SERVO_INTERNAL_PRIVATE_SERVER_HPP
+
+#include <string>
+#include <vector>
+
+namespace servo {
+
+// Resident interpreter (`servocomp --serve`) and its client (`--client`).
+//
+// The server listens on a Unix domain socket and pre-forks `workers` processes
+// that accept requests in turn. A worker keeps builtins and imported modules
+// warm across requests. Workers are processes, not threads, because a
+// script's output goes to process-wide file descriptors, its own and those of
+// the commands it runs.
+//
+// A request carries the client's stdin/stdout/stderr (SCM_RIGHTS), its working
+// directory, a script path or inline source, and the script's arguments. The
+// worker runs the script with those descriptors as 0/1/2, so output streams
+// straight to the client, then replies with the 4-byte exit status. The
+// socket is created owner-only and both ends check SO_PEERCRED, so descriptors
+// only ever pass between processes of the same user.
+class Server {
+public:
+    struct Request {
+        std::string cwd;
+        bool inline_source = false;
+        std::string script; // path, or source when inline_source
+        std::vector<std::string> args;
+    };
+
+    static std::string defaultSocket();
+    static int serve(const std::string& socket_path, int workers);
+    static int client(const std::string& socket_path, const Request& request);
+
+private:
+    static void work(int listener);
+    static void handle(int connection);
+};
+
+}
+
+#endif
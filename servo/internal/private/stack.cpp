@@ -0,0 +1,96 @@
+#include "stack.hpp"
+#include "parser.hpp"
+#include <exception>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+namespace servo {
+
+namespace {
+
+struct Region {
+    char* base = nullptr;
+    size_t size = 0;
+    ~Region() { if (base) munmap(base, size); }
+};
+
+thread_local Region region;
+thread_local bool on_region = false;
+
+// The lowest usable address of the current thread's own stack.
+const char* threadLimit() {
+    pthread_attr_t attr;
+    void* addr = nullptr;
+    size_t size = 0;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstack(&attr, &addr, &size);
+        pthread_attr_destroy(&attr);
+    }
+    return addr ? static_cast<const char*>(addr) + NativeStack::margin : nullptr;
+}
+
+struct Entry {
+    const std::function<void()>* fn;
+    std::exception_ptr error;
+    ucontext_t caller;
+};
+thread_local Entry* entry = nullptr;
+
+void trampoline() {
+    try {
+        (*entry->fn)();
+    } catch (...) {
+        entry->error = std::current_exception();
+    }
+    // Returning resumes uc_link, the caller.
+}
+
+}
+
+const char*& NativeStack::limit() {
+    thread_local const char* value = threadLimit();
+    return value;
+}
+
+void NativeStack::run(const std::function<void()>& fn) {
+    size_t want = Parser::max_depth * frame_bytes + 2 * margin;
+    if (on_region || want <= 8 * 1024 * 1024) return fn(); // nested, or the thread stack is enough
+
+    if (region.size < want) {
+        if (region.base) munmap(region.base, region.size);
+        region = {};
+        // Reserve address space only; fall back to smaller sizes if refused.
+        for (size_t size = want; size >= 8 * 1024 * 1024; size /= 2) {
+            void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+            if (mem != MAP_FAILED) {
+                region.base = static_cast<char*>(mem);
+                region.size = size;
+                break;
+            }
+        }
+        if (!region.base) return fn();
+    }
+
+    Entry here{&fn, nullptr, {}};
+    ucontext_t context;
+    getcontext(&context);
+    context.uc_stack.ss_sp = region.base;
+    context.uc_stack.ss_size = region.size;
+    context.uc_link = &here.caller;
+    makecontext(&context, trampoline, 0);
+
+    Entry* outer_entry = entry;
+    const char* outer_limit = limit();
+    entry = &here;
+    limit() = region.base + margin;
+    on_region = true;
+    swapcontext(&here.caller, &context);
+    on_region = false;
+    madvise(region.base, region.size, MADV_DONTNEED); // give back what deep recursion touched
+    limit() = outer_limit;
+    entry = outer_entry;
+    if (here.error) std::rethrow_exception(here.error);
+}
+
+}
@@ -0,0 +1,32 @@
+#ifndef SERVO_INTERNAL_PRIVATE_STACK_HPP
+#define SERVO_INTERNAL_PRIVATE_STACK_HPP
+
+#include <cstddef>
+#include <functional>
+
+namespace servo {
+
+// Native stack for the interpreter. Each servo call still nests a few C++
+// frames, so deep recursion needs a deep native stack: run() executes a
+// script on a lazily committed mmap region sized for Parser::max_depth
+// calls (reserved once per thread, pages touched only as deep as the
+// recursion actually goes). exhausted() lets calls fail with a servo error
+// instead of overflowing when the region (or a plain thread stack) runs out.
+class NativeStack {
+public:
+    static constexpr size_t frame_bytes = 8 * 1024; // reserved per servo call
+    static constexpr size_t margin = 256 * 1024;    // kept free for natives and error handling
+
+    static void run(const std::function<void()>& fn);
+    static bool exhausted() {
+        char here;
+        return &here < limit();
+    }
+
+private:
+    static const char*& limit();
+};
+
+}
+
+#endif
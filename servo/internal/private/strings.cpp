@@ -0,0 +1,271 @@
+#include "strings.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace servo {
+
+namespace {
+
+// One implementation per level. find() is called with 1 <= k <= n.
+struct Kernels {
+    size_t (*find)(const char* s, size_t n, const char* p, size_t k);
+    size_t (*countByte)(const char* s, size_t n, char c);
+    void (*mapCase)(const char* in, char* out, size_t n, bool upper);
+};
+
+size_t findScalar(const char* s, size_t n, const char* p, size_t k) {
+    return std::string_view(s, n).find(std::string_view(p, k));
+}
+
+size_t countByteScalar(const char* s, size_t n, char c) {
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) total += s[i] == c;
+    return total;
+}
+
+void mapCaseScalar(const char* in, char* out, size_t n, bool upper) {
+    unsigned char from = upper ? 'a' : 'A';
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char c = in[i];
+        out[i] = static_cast<char>(c ^ ((static_cast<unsigned char>(c - from) < 26) << 5));
+    }
+}
+
+// Finishes a vector loop that stopped at i.
+size_t findTail(const char* s, size_t n, const char* p, size_t k, size_t i) {
+    size_t r = findScalar(s + i, n - i, p, k);
+    return r == Strings::npos ? r : i + r;
+}
+
+#if defined(__x86_64__)
+
+// Substring search compares the needle's first and last bytes against a
+// block of candidate positions at once and only memcmps positions where
+// both match. Byte counting accumulates cmpeq results (-1 per match) in
+// 8-bit lanes and folds them with psadbw before they can overflow.
+
+size_t findSSE2(const char* s, size_t n, const char* p, size_t k) {
+    const __m128i first = _mm_set1_epi8(p[0]), last = _mm_set1_epi8(p[k - 1]);
+    size_t i = 0;
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + k - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (k <= 2 || std::memcmp(s + i + bit + 1, p + 1, k - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findTail(s, n, p, k, i);
+}
+
+size_t countByteSSE2(const char* s, size_t n, char c) {
+    const __m128i target = _mm_set1_epi8(c), zero = _mm_setzero_si128();
+    __m128i totals = zero;
+    size_t i = 0;
+    while (i + 16 <= n) {
+        __m128i lanes = zero;
+        for (int step = 0; step < 255 && i + 16 <= n; ++step, i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            lanes = _mm_sub_epi8(lanes, _mm_cmpeq_epi8(a, target));
+        }
+        totals = _mm_add_epi64(totals, _mm_sad_epu8(lanes, zero));
+    }
+    size_t total = static_cast<size_t>(_mm_cvtsi128_si64(totals) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(totals, totals)));
+    return total + countByteScalar(s + i, n - i, c);
+}
+
+void mapCaseSSE2(const char* in, char* out, size_t n, bool upper) {
+    // Signed compares: bytes >= 0x80 are negative and never in range.
+    const __m128i lo = _mm_set1_epi8(upper ? 'a' - 1 : 'A' - 1), hi = _mm_set1_epi8(upper ? 'z' + 1 : 'Z' + 1);
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(a, lo), _mm_cmplt_epi8(a, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(a, _mm_and_si128(letters, flip)));
+    }
+    mapCaseScalar(in + i, out + i, n - i, upper);
+}
+
+__attribute__((target("avx2")))
+size_t findAVX2(const char* s, size_t n, const char* p, size_t k) {
+    const __m256i first = _mm256_set1_epi8(p[0]), last = _mm256_set1_epi8(p[k - 1]);
+    size_t i = 0;
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (k <= 2 || std::memcmp(s + i + bit + 1, p + 1, k - 2) == 0) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findTail(s, n, p, k, i);
+}
+
+__attribute__((target("avx2")))
+size_t countByteAVX2(const char* s, size_t n, char c) {
+    const __m256i target = _mm256_set1_epi8(c), zero = _mm256_setzero_si256();
+    __m256i totals = zero;
+    size_t i = 0;
+    while (i + 32 <= n) {
+        __m256i lanes = zero;
+        for (int step = 0; step < 255 && i + 32 <= n; ++step, i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            lanes = _mm256_sub_epi8(lanes, _mm256_cmpeq_epi8(a, target));
+        }
+        totals = _mm256_add_epi64(totals, _mm256_sad_epu8(lanes, zero));
+    }
+    size_t total = static_cast<size_t>(_mm256_extract_epi64(totals, 0) + _mm256_extract_epi64(totals, 1)
+        + _mm256_extract_epi64(totals, 2) + _mm256_extract_epi64(totals, 3));
+    return total + countByteScalar(s + i, n - i, c);
+}
+
+__attribute__((target("avx2")))
+void mapCaseAVX2(const char* in, char* out, size_t n, bool upper) {
+    const __m256i lo = _mm256_set1_epi8(upper ? 'a' - 1 : 'A' - 1), hi = _mm256_set1_epi8(upper ? 'z' + 1 : 'Z' + 1);
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(a, lo), _mm256_cmpgt_epi8(hi, a));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(a, _mm256_and_si256(letters, flip)));
+    }
+    mapCaseScalar(in + i, out + i, n - i, upper);
+}
+
+const Kernels kernels[] = {
+    {findScalar, countByteScalar, mapCaseScalar},
+    {findSSE2, countByteSSE2, mapCaseSSE2},
+    {findAVX2, countByteAVX2, mapCaseAVX2},
+};
+
+#else
+
+const Kernels kernels[] = {{findScalar, countByteScalar, mapCaseScalar}};
+
+#endif
+
+std::atomic<int>& current() {
+    static std::atomic<int> level{static_cast<int>(Strings::supported())};
+    return level;
+}
+
+const Kernels& active() {
+    return kernels[current().load(std::memory_order_relaxed)];
+}
+
+bool space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+}
+
+Strings::Level Strings::supported() {
+#if defined(__x86_64__)
+    // SSE2 is part of x86-64; AVX2 also needs the OS to save YMM state,
+    // which __builtin_cpu_supports checks.
+    static const Level level = __builtin_cpu_supports("avx2") ? Level::AVX2 : Level::SSE2;
+    return level;
+#else
+    return Level::Scalar;
+#endif
+}
+
+Strings::Level Strings::level() {
+    return static_cast<Level>(current().load(std::memory_order_relaxed));
+}
+
+void Strings::setLevel(Level l) {
+    if (l > supported()) l = supported();
+    current().store(static_cast<int>(l), std::memory_order_relaxed);
+}
+
+const char* Strings::name(Level l) {
+    switch (l) {
+        case Level::Scalar: return "scalar";
+        case Level::SSE2: return "sse2";
+        case Level::AVX2: return "avx2";
+    }
+    return "?";
+}
+
+size_t Strings::find(std::string_view text, std::string_view needle, size_t from) {
+    if (from > text.size()) return npos;
+    if (needle.empty()) return from;
+    if (needle.size() > text.size() - from) return npos;
+    size_t r = active().find(text.data() + from, text.size() - from, needle.data(), needle.size());
+    return r == npos ? npos : from + r;
+}
+
+size_t Strings::count(std::string_view text, std::string_view needle) {
+    if (needle.empty()) return 0;
+    if (needle.size() == 1) return active().countByte(text.data(), text.size(), needle[0]);
+    size_t total = 0;
+    for (size_t pos = find(text, needle); pos != npos; pos = find(text, needle, pos + needle.size())) total++;
+    return total;
+}
+
+std::vector<std::string_view> Strings::split(std::string_view text, std::string_view separator) {
+    std::vector<std::string_view> pieces;
+    if (separator.empty()) {
+        size_t i = 0;
+        while (true) {
+            while (i < text.size() && space(text[i])) i++;
+            if (i == text.size()) break;
+            size_t start = i;
+            while (i < text.size() && !space(text[i])) i++;
+            pieces.push_back(text.substr(start, i - start));
+        }
+        return pieces;
+    }
+    size_t start = 0;
+    for (size_t pos = find(text, separator); pos != npos; pos = find(text, separator, start)) {
+        pieces.push_back(text.substr(start, pos - start));
+        start = pos + separator.size();
+    }
+    pieces.push_back(text.substr(start));
+    return pieces;
+}
+
+std::string Strings::replace(std::string_view text, std::string_view from, std::string_view to) {
+    if (from.empty()) return std::string(text);
+    std::string out;
+    size_t start = 0;
+    for (size_t pos = find(text, from); pos != npos; pos = find(text, from, start)) {
+        if (out.empty()) out.reserve(text.size());
+        out.append(text.data() + start, pos - start);
+        out.append(to);
+        start = pos + from.size();
+    }
+    out.append(text.data() + start, text.size() - start);
+    return out;
+}
+
+std::string Strings::upper(std::string_view text) {
+    std::string out(text.size(), '\0');
+    active().mapCase(text.data(), out.data(), text.size(), true);
+    return out;
+}
+
+std::string Strings::lower(std::string_view text) {
+    std::string out(text.size(), '\0');
+    active().mapCase(text.data(), out.data(), text.size(), false);
+    return out;
+}
+
+std::string_view Strings::trim(std::string_view text) {
+    size_t start = 0, end = text.size();
+    while (start < end && space(text[start])) start++;
+    while (end > start && space(text[end - 1])) end--;
+    return text.substr(start, end - start);
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef SERVO_INTERNAL_PRIVATE_STRINGS_HPP
+#define SERVO_INTERNAL_PRIVATE_STRINGS_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace servo {
+
+// Scanning kernels behind the system_string module. The byte loops run 32
+// (AVX2) or 16 (SSE2) bytes per step; the widest level the CPU supports is
+// picked on first use, with a scalar fallback on other architectures.
+class Strings {
+public:
+    enum class Level { Scalar, SSE2, AVX2 };
+
+    static Level level();          // in use
+    static Level supported();      // widest the CPU can run
+    static void setLevel(Level l); // clamped to supported(); for benchmarks
+    static const char* name(Level l);
+
+    static constexpr size_t npos = std::string_view::npos;
+
+    static size_t find(std::string_view text, std::string_view needle, size_t from = 0);
+    // Non-overlapping occurrences; an empty needle counts nothing.
+    static size_t count(std::string_view text, std::string_view needle);
+    // Pieces between separators; an empty separator splits on whitespace runs.
+    // Views point into text.
+    static std::vector<std::string_view> split(std::string_view text, std::string_view separator);
+    static std::string replace(std::string_view text, std::string_view from, std::string_view to);
+    static std::string upper(std::string_view text);
+    static std::string lower(std::string_view text);
+    static std::string_view trim(std::string_view text);
+};
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef SERVO_INTERNAL_PUBLIC_BINDING_HPP
+#define SERVO_INTERNAL_PUBLIC_BINDING_HPP
+
+#include <any>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "collection.hpp"
+#include "expression.hpp"
+#include "variable.hpp"
+
+namespace servo {
+
+// Native binding: servo::bind<&Builtins::systemreturn>("systemreturn") makes a
+// builtin Variable from a plain C++ function. Argument unmarshalling and
+// result boxing are generated from the signature at compile time, and the
+// Variable holds a NativeFunction, so a call is one direct call into the
+// generated thunk, which calls the function directly. Missing arguments
+// are default values ("" / 0), as in the hand-written builtins.
+//
+// Parameters: std::string, String, std::string_view (borrows the argument),
+// integers, double, bool, List, Map, std::any. Results: those (a
+// std::string_view is copied), or void.
+namespace binding {
+
+template <typename T, typename = void>
+struct Arg {
+    static_assert(sizeof(T) == 0, "servo::bind: unsupported parameter type");
+};
+
+template <>
+struct Arg<String> {
+    using Storage = String;
+    static Storage get(const std::any& v) { return Expression::toString(v); }
+    static String pass(Storage& s) { return s; }
+};
+
+template <>
+struct Arg<std::string> {
+    using Storage = String;
+    static Storage get(const std::any& v) { return Expression::toString(v); }
+    static std::string pass(Storage& s) { return s.str(); }
+};
+
+template <>
+struct Arg<std::string_view> {
+    using Storage = String; // keeps the bytes alive for the call
+    static Storage get(const std::any& v) { return Expression::toString(v); }
+    static std::string_view pass(Storage& s) { return s.view(); }
+};
+
+template <typename T>
+struct Arg<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    using Storage = T;
+    static Storage get(const std::any& v) {
+        String text = Expression::toString(v);
+        T out{};
+        auto view = text.view();
+        auto [end, ec] = std::from_chars(view.data(), view.data() + view.size(), out);
+        if (ec != std::errc() || end != view.data() + view.size()) {
+            throw std::runtime_error("expected an integer argument, got '" + text.str() + "'");
+        }
+        return out;
+    }
+    static T pass(Storage& s) { return s; }
+};
+
+template <>
+struct Arg<double> {
+    using Storage = double;
+    static Storage get(const std::any& v) {
+        String text = Expression::toString(v);
+        std::string s = text.str();
+        char* end = nullptr;
+        double out = std::strtod(s.c_str(), &end);
+        if (s.empty() || *end != '\0') throw std::runtime_error("expected a number argument, got '" + s + "'");
+        return out;
+    }
+    static double pass(Storage& s) { return s; }
+};
+
+template <>
+struct Arg<bool> {
+    using Storage = bool;
+    static Storage get(const std::any& v) { return Expression::truthy(v); }
+    static bool pass(Storage& s) { return s; }
+};
+
+template <typename T>
+struct Arg<T, std::enable_if_t<std::is_same_v<T, List> || std::is_same_v<T, Map>>> {
+    using Storage = T;
+    static Storage get(const std::any& v) {
+        if (auto* c = std::any_cast<T>(&v)) return *c;
+        throw std::runtime_error(std::is_same_v<T, List> ? "expected a list argument" : "expected a map argument");
+    }
+    static T pass(Storage& s) { return s; }
+};
+
+template <>
+struct Arg<std::any> {
+    using Storage = std::any;
+    static Storage get(const std::any& v) { return v; }
+    static std::any pass(Storage& s) { return s; }
+};
+
+template <typename T>
+void box(T&& value, std::any& result) {
+    using V = std::decay_t<T>;
+    if constexpr (std::is_same_v<V, String> || std::is_same_v<V, List> || std::is_same_v<V, Map> || std::is_same_v<V, std::any>) {
+        result = std::forward<T>(value);
+    } else if constexpr (std::is_same_v<V, std::string>) {
+        result = String(std::forward<T>(value));
+    } else if constexpr (std::is_same_v<V, std::string_view>) {
+        result = String(std::string(value));
+    } else if constexpr (std::is_same_v<V, bool>) {
+        result = Expression::boolean(value);
+    } else if constexpr (std::is_integral_v<V>) {
+        result = String(std::to_string(value));
+    } else if constexpr (std::is_floating_point_v<V>) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.15g", static_cast<double>(value));
+        result = String(std::string(buf));
+    } else {
+        static_assert(sizeof(V) == 0, "servo::bind: unsupported result type");
+    }
+}
+
+template <typename Signature, Signature F>
+struct Thunk;
+
+template <typename R, typename... P, R (*F)(P...)>
+struct Thunk<R (*)(P...), F> {
+    static void call(Args args, std::any& result) {
+        call(args, result, std::index_sequence_for<P...>{});
+    }
+
+    template <size_t... I>
+    static void call(Args args, std::any& result, std::index_sequence<I...>) {
+        // Unmarshalled left to right before the call.
+        std::tuple<typename Arg<std::decay_t<P>>::Storage...> values{
+            (I < args.size() ? Arg<std::decay_t<P>>::get(args[I]) : typename Arg<std::decay_t<P>>::Storage{})...};
+        if constexpr (std::is_void_v<R>) {
+            F(Arg<std::decay_t<P>>::pass(std::get<I>(values))...);
+        } else {
+            box(F(Arg<std::decay_t<P>>::pass(std::get<I>(values))...), result);
+        }
+        (void)args;
+    }
+};
+
+}
+
+// The generated thunk for F, as stored in a Variable.
+template <auto F>
+constexpr NativeFunction native() {
+    return &binding::Thunk<decltype(F), F>::call;
+}
+
+template <auto F>
+std::shared_ptr<Variable> bind(Symbol name) {
+    return std::make_shared<Variable>(name, native<F>(), "func", std::map<Symbol, std::shared_ptr<Variable>>{}, nullptr);
+}
+
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include "collection.hpp"
+#include <functional>
+#include <string_view>
+
+namespace servo {
+
+std::any* List::at(long long index) const {
+    long long n = static_cast<long long>(rep->items.size());
+    if (index < 0) index += n;
+    if (index < 0 || index >= n) return nullptr;
+    return &rep->items[static_cast<size_t>(index)];
+}
+
+uint64_t Map::hash(const String& key) {
+    return std::hash<std::string_view>()(key.view());
+}
+
+int64_t Map::lookup(const String& key, uint64_t h) const {
+    if (rep->slots.empty()) return -1;
+    size_t mask = rep->slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        int32_t slot = rep->slots[i];
+        if (slot == empty) return -1;
+        if (slot >= 0) {
+            const Entry& e = rep->entries[slot];
+            if (e.hash == h && e.key.view() == key.view()) return static_cast<int64_t>(i);
+        }
+    }
+}
+
+void Map::rebuild(size_t capacity) const {
+    // Compact the entries (dropping removed ones) and re-index them.
+    size_t kept = 0;
+    for (auto& e : rep->entries) {
+        if (!e.live) continue;
+        if (&e != &rep->entries[kept]) rep->entries[kept] = std::move(e);
+        kept++;
+    }
+    rep->entries.resize(kept);
+    rep->slots.assign(capacity, empty);
+    size_t mask = capacity - 1;
+    for (size_t k = 0; k < kept; ++k) {
+        size_t i = rep->entries[k].hash & mask;
+        while (rep->slots[i] != empty) i = (i + 1) & mask;
+        rep->slots[i] = static_cast<int32_t>(k);
+    }
+}
+
+std::any* Map::find(const String& key) const {
+    int64_t i = lookup(key, hash(key));
+    return i < 0 ? nullptr : &rep->entries[rep->slots[i]].value;
+}
+
+void Map::set(const String& key, std::any value) const {
+    uint64_t h = hash(key);
+    int64_t i = lookup(key, h);
+    if (i >= 0) {
+        rep->entries[rep->slots[i]].value = std::move(value);
+        return;
+    }
+    // Entries (removed ones included) never exceed 3/4 of the slots; a
+    // rebuild compacts them and leaves live entries at most 3/8 full.
+    if ((rep->entries.size() + 1) * 4 > rep->slots.size() * 3) {
+        size_t capacity = 8;
+        while (capacity * 3 < (rep->live + 1) * 8) capacity *= 2;
+        rebuild(capacity);
+    }
+    size_t mask = rep->slots.size() - 1;
+    size_t slot = h & mask;
+    while (rep->slots[slot] >= 0) slot = (slot + 1) & mask;
+    rep->slots[slot] = static_cast<int32_t>(rep->entries.size());
+    rep->entries.push_back(Entry{key, std::move(value), h, true});
+    rep->live++;
+}
+
+bool Map::remove(const String& key) const {
+    int64_t i = lookup(key, hash(key));
+    if (i < 0) return false;
+    Entry& e = rep->entries[rep->slots[i]];
+    e.live = false;
+    e.value.reset();
+    rep->slots[i] = removed;
+    rep->live--;
+    return true;
+}
+
+std::vector<String> Map::keys() const {
+    std::vector<String> out;
+    out.reserve(rep->live);
+    for (auto& e : rep->entries) {
+        if (e.live) out.push_back(e.key);
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,117 @@
+#ifndef SERVO_INTERNAL_PUBLIC_COLLECTION_HPP
+#define SERVO_INTERNAL_PUBLIC_COLLECTION_HPP
+
+#include <any>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "string.hpp"
+
+namespace servo {
+
+// List and Map values. Like String they are one pointer to a refcounted Rep,
+// so they sit in std::any's in-place storage; unlike String they are mutable
+// and copies share the same storage (`b = a` aliases, as in most scripting
+// languages). As with String, a moved-from value is left on a shared empty
+// Rep rather than null, so reading it is safe; it is never written through.
+
+// Contiguous vector of values.
+class List {
+public:
+    List() : rep(new Rep) {}
+    explicit List(std::vector<std::any> items) : rep(new Rep) { rep->items = std::move(items); }
+    List(const List& other) noexcept : rep(other.rep) { retain(); }
+    List(List&& other) noexcept : rep(other.rep) {
+        other.rep = emptyRep();
+        other.retain();
+    }
+    List& operator=(List other) noexcept { std::swap(rep, other.rep); return *this; }
+    ~List() { release(); }
+
+    size_t size() const { return rep->items.size(); }
+    std::vector<std::any>& items() const { return rep->items; }
+    // Index from the front, or from the back when negative; nullptr when out of range.
+    std::any* at(long long index) const;
+    void append(std::any value) const { rep->items.push_back(std::move(value)); }
+    bool same(const List& other) const { return rep == other.rep; }
+
+private:
+    struct Rep {
+        std::atomic<long> refs{1};
+        std::vector<std::any> items;
+    };
+    Rep* rep;
+
+    static Rep* emptyRep() {
+        // Never freed: the static holds one reference forever.
+        static Rep* rep = new Rep;
+        return rep;
+    }
+    void retain() const { rep->refs.fetch_add(1, std::memory_order_relaxed); }
+    void release() {
+        if (rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete rep;
+    }
+};
+
+// Hash map from String keys to values: open addressing with linear probing
+// over a power-of-two slot table that indexes a dense, insertion-ordered
+// entry array. Keys hash and compare by their bytes, never via conversion.
+class Map {
+public:
+    Map() : rep(new Rep) {}
+    Map(const Map& other) noexcept : rep(other.rep) { retain(); }
+    Map(Map&& other) noexcept : rep(other.rep) {
+        other.rep = emptyRep();
+        other.retain();
+    }
+    Map& operator=(Map other) noexcept { std::swap(rep, other.rep); return *this; }
+    ~Map() { release(); }
+
+    size_t size() const { return rep->live; }
+    std::any* find(const String& key) const;
+    bool contains(const String& key) const { return find(key) != nullptr; }
+    void set(const String& key, std::any value) const;
+    bool remove(const String& key) const;
+    std::vector<String> keys() const; // insertion order
+    bool same(const Map& other) const { return rep == other.rep; }
+
+    // Entries in insertion order, including removed ones (skip !live).
+    struct Entry {
+        String key;
+        std::any value;
+        uint64_t hash;
+        bool live;
+    };
+    const std::vector<Entry>& entries() const { return rep->entries; }
+
+private:
+    static constexpr int32_t empty = -1, removed = -2;
+    struct Rep {
+        std::atomic<long> refs{1};
+        std::vector<Entry> entries;
+        std::vector<int32_t> slots; // entry index, empty or removed
+        size_t live = 0;
+    };
+    Rep* rep;
+
+    static uint64_t hash(const String& key);
+    // Slot holding key, or -1.
+    int64_t lookup(const String& key, uint64_t h) const;
+    void rebuild(size_t capacity) const;
+
+    static Rep* emptyRep() {
+        // Never freed: the static holds one reference forever.
+        static Rep* rep = new Rep;
+        return rep;
+    }
+    void retain() const { rep->refs.fetch_add(1, std::memory_order_relaxed); }
+    void release() {
+        if (rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete rep;
+    }
+};
+
+static_assert(sizeof(List) == sizeof(void*) && sizeof(Map) == sizeof(void*), "collections must fit std::any's in-place storage");
+
+}
+
+#endif
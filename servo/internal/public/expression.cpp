@@ -0,0 +1,419 @@
+#include "expression.hpp"
+#include "collection.hpp"
+#include "../private/parser.hpp"
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace servo {
+
+namespace {
+
+// Values are strings; arithmetic reads them as integers when they have no
+// fractional part (matching bc's scale=0 division) and as doubles otherwise.
+struct Number {
+    bool is_int = true;
+    long long i = 0;
+    double d = 0;
+
+    double real() const { return is_int ? static_cast<double>(i) : d; }
+};
+
+bool parseNumber(std::string_view text, Number& out) {
+    if (text.empty()) return false;
+    size_t pos = (text[0] == '-') ? 1 : 0;
+    bool digits = false, dot = false, exponent = false;
+    size_t k = pos;
+    for (; k < text.size(); ++k) {
+        char c = text[k];
+        if (c >= '0' && c <= '9') digits = true;
+        else if (c == '.' && !dot) dot = true;
+        else break;
+    }
+    if (!digits) return false;
+    if (k < text.size()) {
+        // formatNumber prints large and tiny floats as "1.5e+20" / "1e-05".
+        if (text[k] != 'e' && text[k] != 'E') return false;
+        if (++k < text.size() && (text[k] == '+' || text[k] == '-')) ++k;
+        if (k == text.size()) return false;
+        for (; k < text.size(); ++k) {
+            if (text[k] < '0' || text[k] > '9') return false;
+        }
+        exponent = true;
+    }
+
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    if (!dot && !exponent) {
+        auto res = std::from_chars(first, last, out.i);
+        if (res.ec == std::errc()) {
+            out.is_int = true;
+            return true;
+        }
+    }
+    // bc prints fractions without a leading zero (".5"); strtod accepts both forms.
+    out.is_int = false;
+    out.d = std::strtod(std::string(text).c_str(), nullptr);
+    return true;
+}
+
+String formatNumber(const Number& n) {
+    if (n.is_int) return String(std::to_string(n.i));
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.15g", n.d);
+    return String(std::string(buf));
+}
+
+Number makeReal(double d) {
+    Number n;
+    n.is_int = false;
+    n.d = d;
+    return n;
+}
+
+Number makeInt(long long i) {
+    Number n;
+    n.i = i;
+    return n;
+}
+
+Number arithmetic(Expression::Op op, const Number& a, const Number& b) {
+    if (a.is_int && b.is_int) {
+        long long r;
+        switch (op) {
+            case Expression::Op::Add: if (!__builtin_add_overflow(a.i, b.i, &r)) return makeInt(r); break;
+            case Expression::Op::Sub: if (!__builtin_sub_overflow(a.i, b.i, &r)) return makeInt(r); break;
+            case Expression::Op::Mul: if (!__builtin_mul_overflow(a.i, b.i, &r)) return makeInt(r); break;
+            case Expression::Op::Div:
+                if (b.i == 0) throw std::runtime_error("division by zero");
+                return makeInt(a.i / b.i);
+            case Expression::Op::Mod:
+                if (b.i == 0) throw std::runtime_error("division by zero");
+                return makeInt(a.i % b.i);
+            case Expression::Op::Pow:
+                if (b.i >= 0) {
+                    // |base| <= 1 never overflows, however large the exponent.
+                    if (a.i == 0) return makeInt(b.i == 0 ? 1 : 0);
+                    if (a.i == 1) return makeInt(1);
+                    if (a.i == -1) return makeInt(b.i % 2 ? -1 : 1);
+                    // By squaring: the base is only squared while bits remain,
+                    // so any overflow means the exact result does not fit.
+                    long long acc = 1, base = a.i, e = b.i;
+                    bool overflow = false;
+                    while (!overflow) {
+                        if (e & 1) overflow = __builtin_mul_overflow(acc, base, &acc);
+                        e >>= 1;
+                        if (!e) break;
+                        if (!overflow) overflow = __builtin_mul_overflow(base, base, &base);
+                    }
+                    if (!overflow) return makeInt(acc);
+                }
+                break;
+            default: break;
+        }
+    }
+    double x = a.real(), y = b.real();
+    switch (op) {
+        case Expression::Op::Add: return makeReal(x + y);
+        case Expression::Op::Sub: return makeReal(x - y);
+        case Expression::Op::Mul: return makeReal(x * y);
+        case Expression::Op::Div:
+            if (y == 0) throw std::runtime_error("division by zero");
+            return makeReal(x / y);
+        case Expression::Op::Mod:
+            if (y == 0) throw std::runtime_error("division by zero");
+            return makeReal(std::fmod(x, y));
+        case Expression::Op::Pow: return makeReal(std::pow(x, y));
+        default: break;
+    }
+    throw std::runtime_error(std::string("operator '") + Expression::opName(op) + "' is not arithmetic");
+}
+
+void describe(const std::any& value, std::string& out, int depth) {
+    // Containers print as [a, b] / {k: v}; nesting (or a cycle) is cut off at 32 levels.
+    if (auto* list = std::any_cast<List>(&value)) {
+        if (depth > 32) { out += "[...]"; return; }
+        out += '[';
+        for (size_t i = 0; i < list->size(); ++i) {
+            if (i) out += ", ";
+            describe(list->items()[i], out, depth + 1);
+        }
+        out += ']';
+    } else if (auto* map = std::any_cast<Map>(&value)) {
+        if (depth > 32) { out += "{...}"; return; }
+        out += '{';
+        bool first = true;
+        for (auto& e : map->entries()) {
+            if (!e.live) continue;
+            if (!first) out += ", ";
+            first = false;
+            out += e.key.view();
+            out += ": ";
+            describe(e.value, out, depth + 1);
+        }
+        out += '}';
+    } else {
+        out += Expression::toString(value).view();
+    }
+}
+
+bool isContainer(const std::any& value) {
+    return value.type() == typeid(List) || value.type() == typeid(Map);
+}
+
+int compare(const String& a, const String& b) {
+    Number x, y;
+    if (parseNumber(a.view(), x) && parseNumber(b.view(), y)) {
+        if (x.is_int && y.is_int) return (x.i < y.i) ? -1 : (x.i > y.i);
+        return (x.real() < y.real()) ? -1 : (x.real() > y.real());
+    }
+    int c = a.view().compare(b.view());
+    return (c < 0) ? -1 : (c > 0);
+}
+
+
+}
+
+const char* Expression::opName(Op op) {
+    switch (op) {
+        case Op::Add: return "+";
+        case Op::Sub: case Op::Neg: return "-";
+        case Op::Mul: return "*";
+        case Op::Div: return "/";
+        case Op::Mod: return "%";
+        case Op::Pow: return "^";
+        case Op::Eq: return "==";
+        case Op::Ne: return "!=";
+        case Op::Lt: return "<";
+        case Op::Gt: return ">";
+        case Op::Le: return "<=";
+        case Op::Ge: return ">=";
+        case Op::And: return "&&";
+        case Op::Or: return "||";
+        case Op::Not: return "!";
+        case Op::In: return "in";
+        default: return "?";
+    }
+}
+
+String Expression::toString(const std::any& value) {
+    if (value.type() == typeid(String)) return std::any_cast<const String&>(value);
+    if (value.type() == typeid(std::string)) return String(std::any_cast<const std::string&>(value));
+    if (value.type() == typeid(int)) return String(std::to_string(std::any_cast<int>(value)));
+    if (isContainer(value)) {
+        std::string out;
+        describe(value, out, 0);
+        return String(std::move(out));
+    }
+    return String();
+}
+
+bool Expression::truthy(const std::any& value) {
+    if (!value.has_value()) return false;
+    if (auto* list = std::any_cast<List>(&value)) return list->size() > 0;
+    if (auto* map = std::any_cast<Map>(&value)) return map->size() > 0;
+    if (value.type() != typeid(String) && value.type() != typeid(std::string)) return true;
+    String s = toString(value);
+    if (s.empty()) return false;
+    Number n;
+    if (parseNumber(s.view(), n)) return n.real() != 0;
+    return true;
+}
+
+std::any Expression::boolean(bool b) {
+    static const String yes(Symbol("1")), no(Symbol("0"));
+    return b ? yes : no;
+}
+
+String Expression::mapKey(const std::any& key) {
+    if (isContainer(key)) throw std::runtime_error("lists and maps cannot be map keys");
+    return toString(key);
+}
+
+static long long listIndex(const std::any& key) {
+    Number n;
+    String text = Expression::toString(key);
+    if (!parseNumber(text.view(), n) || !n.is_int) throw std::runtime_error("list index must be an integer, got '" + text.str() + "'");
+    return n.i;
+}
+
+std::any Expression::index(const std::any& container, const std::any& key) {
+    if (auto* list = std::any_cast<List>(&container)) {
+        if (auto* item = list->at(listIndex(key))) return *item;
+        throw std::runtime_error("list index " + toString(key).str() + " out of range (size " + std::to_string(list->size()) + ")");
+    }
+    if (auto* map = std::any_cast<Map>(&container)) {
+        if (auto* value = map->find(mapKey(key))) return *value;
+        throw std::runtime_error("key '" + toString(key).str() + "' not in map");
+    }
+    String text = toString(container);
+    long long i = listIndex(key), n = static_cast<long long>(text.size());
+    if (i < 0) i += n;
+    if (i < 0 || i >= n) throw std::runtime_error("string index " + toString(key).str() + " out of range");
+    return String(std::string(1, text.view()[i]));
+}
+
+void Expression::assignIndex(const std::any& container, const std::any& key, std::any value) {
+    if (auto* list = std::any_cast<List>(&container)) {
+        auto* item = list->at(listIndex(key));
+        if (!item) throw std::runtime_error("list index " + toString(key).str() + " out of range (size " + std::to_string(list->size()) + ")");
+        *item = std::move(value);
+    } else if (auto* map = std::any_cast<Map>(&container)) {
+        map->set(mapKey(key), std::move(value));
+    } else {
+        throw std::runtime_error("only lists and maps support item assignment");
+    }
+}
+
+bool Expression::contains(const std::any& container, const std::any& item) {
+    if (auto* map = std::any_cast<Map>(&container)) return map->contains(mapKey(item));
+    if (auto* list = std::any_cast<List>(&container)) {
+        auto* wanted_list = std::any_cast<List>(&item);
+        auto* wanted_map = std::any_cast<Map>(&item);
+        String wanted = wanted_list || wanted_map ? String() : toString(item);
+        for (auto& v : list->items()) {
+            if (wanted_list || wanted_map) {
+                auto* l = std::any_cast<List>(&v);
+                auto* m = std::any_cast<Map>(&v);
+                if ((wanted_list && l && l->same(*wanted_list)) || (wanted_map && m && m->same(*wanted_map))) return true;
+            } else if (!isContainer(v) && compare(toString(v), wanted) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return toString(container).view().find(toString(item).view()) != std::string_view::npos;
+}
+
+std::shared_ptr<Variable> Expression::resolve(Parser* parser) {
+    if (cache.target && cache.version == cache.head.version()) return cache.target;
+
+    auto var = parser->lookupVariable(name.str());
+    if (!var) return nullptr;
+    const std::string& path = name.str();
+    cache.head = Symbol(std::string_view(path).substr(0, path.find('.')));
+    cache.version = cache.head.version();
+    cache.target = var;
+    return var;
+}
+
+void Expression::call(Parser* parser, Args args, std::any& result) {
+    auto callee = resolve(parser);
+    if (!callee) throw std::runtime_error("variable '" + name.str() + "' not found");
+    callee->call(args, result);
+}
+
+std::any Expression::evaluate(Parser* parser) {
+    switch (kind) {
+        case Kind::Literal:
+            return literal;
+
+        case Kind::Variable: {
+            auto var = resolve(parser);
+            // Unknown bare names evaluate to their own text, as they always have.
+            if (!var) return String(name);
+            return var->value;
+        }
+
+        case Kind::Call: {
+            ArgFrame frame(children.size());
+            for (size_t i = 0; i < children.size(); ++i) frame[i] = children[i]->evaluate(parser);
+            std::any result;
+            call(parser, frame.args(), result);
+            return result;
+        }
+
+        case Kind::List: {
+            std::vector<std::any> items;
+            items.reserve(children.size());
+            for (auto& child : children) items.push_back(child->evaluate(parser));
+            return List(std::move(items));
+        }
+
+        case Kind::Map: {
+            Map map;
+            for (size_t i = 0; i + 1 < children.size(); i += 2) {
+                String key = mapKey(children[i]->evaluate(parser));
+                map.set(key, children[i + 1]->evaluate(parser));
+            }
+            return map;
+        }
+
+        case Kind::Index: {
+            std::any container = children[0]->evaluate(parser);
+            return index(container, children[1]->evaluate(parser));
+        }
+
+        case Kind::Unary:
+            return unary(op, children[0]->evaluate(parser));
+
+        case Kind::Binary: {
+            if (op == Op::And) {
+                if (!truthy(children[0]->evaluate(parser))) return boolean(false);
+                return boolean(truthy(children[1]->evaluate(parser)));
+            }
+            if (op == Op::Or) {
+                if (truthy(children[0]->evaluate(parser))) return boolean(true);
+                return boolean(truthy(children[1]->evaluate(parser)));
+            }
+
+            return binary(op, children[0]->evaluate(parser), children[1]->evaluate(parser));
+        }
+    }
+    return std::any();
+}
+
+std::any Expression::unary(Op op, const std::any& value) {
+    if (op == Op::Not) return boolean(!truthy(value));
+    Number n;
+    String s = toString(value);
+    if (!parseNumber(s.view(), n)) throw std::runtime_error("operator '-' expects a number, got '" + s.str() + "'");
+    if (n.is_int && n.i != LLONG_MIN) n.i = -n.i;
+    else n = makeReal(-n.real());
+    return formatNumber(n);
+}
+
+std::any Expression::binary(Op op, const std::any& left, const std::any& right) {
+    // Both operands already evaluated: && and || only short-circuit in evaluate().
+    if (op == Op::And) return boolean(truthy(left) && truthy(right));
+    if (op == Op::Or) return boolean(truthy(left) || truthy(right));
+    if (op == Op::In) return boolean(contains(right, left));
+    if (isContainer(left) || isContainer(right)) {
+        // Containers compare by identity; nothing else applies to them.
+        if (op != Op::Eq && op != Op::Ne) {
+            throw std::runtime_error(std::string("operator '") + opName(op) + "' does not apply to lists or maps");
+        }
+        auto* l1 = std::any_cast<List>(&left);
+        auto* l2 = std::any_cast<List>(&right);
+        auto* m1 = std::any_cast<Map>(&left);
+        auto* m2 = std::any_cast<Map>(&right);
+        bool same = (l1 && l2 && l1->same(*l2)) || (m1 && m2 && m1->same(*m2));
+        return boolean(op == Op::Eq ? same : !same);
+    }
+    String lhs = toString(left);
+    String rhs = toString(right);
+    switch (op) {
+        case Op::Eq: return boolean(compare(lhs, rhs) == 0);
+        case Op::Ne: return boolean(compare(lhs, rhs) != 0);
+        case Op::Lt: return boolean(compare(lhs, rhs) < 0);
+        case Op::Gt: return boolean(compare(lhs, rhs) > 0);
+        case Op::Le: return boolean(compare(lhs, rhs) <= 0);
+        case Op::Ge: return boolean(compare(lhs, rhs) >= 0);
+        default: break;
+    }
+
+    Number a, b;
+    bool numeric = parseNumber(lhs.view(), a) && parseNumber(rhs.view(), b);
+    if (op == Op::Add && !numeric) {
+        // Concatenation appends into lhs's builder buffer when it can.
+        return lhs + rhs;
+    }
+    if (!numeric) {
+        throw std::runtime_error(std::string("operator '") + opName(op) + "' expects numbers, got '" + lhs.str() + "' and '" + rhs.str() + "'");
+    }
+    return formatNumber(arithmetic(op, a, b));
+}
+
+}
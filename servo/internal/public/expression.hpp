@@ -0,0 +1,66 @@
+#ifndef SERVO_INTERNAL_PUBLIC_EXPRESSION_HPP
+#define SERVO_INTERNAL_PUBLIC_EXPRESSION_HPP
+
+#include <any>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include "string.hpp"
+#include "symbol.hpp"
+
+namespace servo {
+
+class Parser;
+class Variable;
+class Args;
+
+// Compiled expression tree. Built once by ExpressionParser and evaluated
+// directly at runtime, so no source text is re-scanned per execution.
+class Expression {
+public:
+    enum class Kind { Literal, Variable, Call, Binary, Unary, List, Map, Index };
+    enum class Op { None, Add, Sub, Mul, Div, Mod, Pow, Eq, Ne, Lt, Gt, Le, Ge, And, Or, Neg, Not, In };
+
+    Kind kind;
+    Op op = Op::None;
+    String literal; // Literal
+    Symbol name;    // Variable / Call (may be a dotted path)
+    std::vector<std::shared_ptr<Expression>> children; // operands, call arguments, list items,
+                                                       // map keys and values alternating, or container and key
+
+    // Monomorphic inline cache for Variable / Call nodes: the last resolved
+    // target, valid while the binding version of the path's head is unchanged.
+    // A node is only ever evaluated against the parser that compiled it.
+    struct Cache {
+        std::shared_ptr<Variable> target;
+        Symbol head;
+        uint32_t version = 0;
+    } cache;
+
+    Expression(Kind kind) : kind(kind) {}
+
+    std::any evaluate(Parser* parser);
+    // Resolve `name` through the inline cache; nullptr when it does not exist.
+    std::shared_ptr<Variable> resolve(Parser* parser);
+    // Invoke this Call node's target with arguments from the caller's frame.
+    void call(Parser* parser, Args args, std::any& result);
+
+    // Value helpers shared by statements and builtins.
+    static String toString(const std::any& value);
+    static bool truthy(const std::any& value);
+    static std::any boolean(bool b); // shared "1" / "0"
+    // Operators applied to evaluated operands (also used by --emit-cpp code).
+    static std::any unary(Op op, const std::any& value);
+    static std::any binary(Op op, const std::any& left, const std::any& right);
+    // container[key] for lists, maps and strings; throws when missing.
+    static std::any index(const std::any& container, const std::any& key);
+    static void assignIndex(const std::any& container, const std::any& key, std::any value);
+    static bool contains(const std::any& container, const std::any& item); // `item in container`
+    static String mapKey(const std::any& key);
+    static const char* opName(Op op);
+};
+
+}
+
+#endif
@@ -1,11 +1,50 @@
 #include "file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
-#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace servo {
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// Reads [offset, offset + length) of an open file. The size is taken from
+// fstat so a whole-file read is one allocation and (usually) one syscall.
+std::string preadAll(int fd, uint64_t offset, uint64_t length) {
+    struct stat st;
+    std::string out;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        uint64_t size = static_cast<uint64_t>(st.st_size);
+        if (offset >= size) return out;
+        out.resize(std::min(length, size - offset));
+    } else {
+        out.resize(std::min<uint64_t>(length, 1 << 16));
+    }
+    size_t got = 0;
+    while (true) {
+        if (got == out.size()) {
+            // Files that grew (or are not regular) are read on in chunks.
+            if (out.size() >= length) break;
+            out.resize(std::min<uint64_t>(length, out.size() * 2 + (1 << 16)));
+        }
+        ssize_t n = ::pread(fd, out.data() + got, out.size() - got, static_cast<off_t>(offset + got));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::runtime_error("read failed: " + std::string(std::strerror(errno)));
+        if (n == 0) break;
+        got += static_cast<size_t>(n);
+    }
+    out.resize(got);
+    return out;
+}
+
+}
+
 File::File(std::string path, bool no_read) {
     // resolve absolute path
     if (!path.empty()) {
@@ -31,11 +70,16 @@ std::string File::read() {
         if (this->path.empty()) {
             throw std::runtime_error("read() while path still not provided to File object.");
         }
-        std::ifstream f(this->path);
-        if (!f.is_open()) return ""; // Or throw?
-        std::stringstream buffer;
-        buffer << f.rdbuf();
-        this->content = buffer.str() + " "; // Add space as per python
+        int fd = ::open(this->path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return ""; // Or throw?
+        try {
+            this->content = preadAll(fd, 0, UINT64_MAX);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        this->content += " "; // Add space as per python
         this->content_loaded = true;
         return this->content;
     }, "servo.internal.public.file");
@@ -56,6 +100,66 @@ void File::write(std::string content, std::string mode) {
     }, "servo.internal.public.file");
 }
 
+std::string File::readRange(uint64_t offset, uint64_t length) {
+    return Safe::call([this, offset, length]() -> std::string {
+        int fd = ::open(this->path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("cannot open " + this->path + ": " + std::strerror(errno));
+        try {
+            std::string data = preadAll(fd, offset, length);
+            ::close(fd);
+            return data;
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }, "servo.internal.public.file");
+}
+
+void File::writeAt(uint64_t offset, const std::string& data) {
+    Safe::call([this, offset, &data]() {
+        int fd = ::open(this->path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) throw std::runtime_error("cannot open " + this->path + ": " + std::strerror(errno));
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::pwrite(fd, data.data() + done, data.size() - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                int err = errno;
+                ::close(fd);
+                throw std::runtime_error("write failed: " + std::string(std::strerror(err)));
+            }
+            done += static_cast<size_t>(n);
+        }
+        ::close(fd);
+        this->content_loaded = false;
+    }, "servo.internal.public.file");
+}
+
+std::vector<std::string> File::list() {
+    return Safe::call([this]() {
+        // readdir returns entries from large getdents batches; no stat per entry.
+        DIR* dir = ::opendir(this->path.c_str());
+        if (!dir) throw std::runtime_error("cannot list " + this->path + ": " + std::strerror(errno));
+        std::vector<std::string> names;
+        while (dirent* entry = ::readdir(dir)) {
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+            names.emplace_back(name);
+        }
+        ::closedir(dir);
+        std::sort(names.begin(), names.end());
+        return names;
+    }, "servo.internal.public.file");
+}
+
+uint64_t File::getSize() {
+    return Safe::call([this]() -> uint64_t {
+        struct stat st;
+        if (::stat(this->path.c_str(), &st) != 0) throw std::runtime_error("cannot stat " + this->path + ": " + std::strerror(errno));
+        return static_cast<uint64_t>(st.st_size);
+    }, "servo.internal.public.file");
+}
+
 std::string File::getContent() {
     return Safe::call([this]() { return this->content; }, "servo.internal.public.file");
 }
@@ -1,6 +1,7 @@
 #ifndef SERVO_INTERNAL_PUBLIC_FILE_HPP
 #define SERVO_INTERNAL_PUBLIC_FILE_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <fstream>
@@ -20,6 +21,13 @@ public:
 
     std::string read();
     void write(std::string content, std::string mode = "w");
+    // Raw bytes [offset, offset + length) straight from disk (pread), not cached.
+    std::string readRange(uint64_t offset = 0, uint64_t length = UINT64_MAX);
+    // Overwrite bytes at offset (pwrite), creating the file if needed.
+    void writeAt(uint64_t offset, const std::string& data);
+    // Sorted entry names of a directory, in one pass.
+    std::vector<std::string> list();
+    uint64_t getSize();
     std::string getContent();
     std::string getPath();
     std::string getExtension();
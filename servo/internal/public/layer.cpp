@@ -3,19 +3,10 @@
 
 namespace servo {
 
-Layer::Layer(std::string name, std::string layer_type, Parser* parser) 
+Layer::Layer(Symbol name, Symbol layer_type, Parser* parser) 
     : name(name), type(layer_type), parser(parser) {
-    // There was no explicit usage of index in __init__ in python for setting it, 
-    // but the python code had `self.index = len(parser.stack) - 1`.
-    // Assuming stack here refers to sys_stack? 
-    // In parser.py: `self.sys_stack: list[Layer] = []`
-    // If Layer is added to stack, it would be there.
-    // If we assume standard usage, we'll check valid stack size.
-    if (!parser->sys_stack.empty()) {
-        this->index = parser->sys_stack.size() - 1;
-    } else {
-        this->index = -1;
-    }
+    // A layer is created to be pushed on top: its index is the current depth.
+    this->index = static_cast<int>(parser->sys_stack.size());
 }
 
 Layer Layer::getAbove() {
@@ -2,22 +2,26 @@
 #define SERVO_INTERNAL_PUBLIC_LAYER_HPP
 
 #include <string>
+#include "symbol.hpp"
 
 namespace servo {
 
 class Parser; // Forward declaration
 
+// One frame of the servo call stack (Parser::sys_stack): the function
+// being run and the parser (activation) running it. Frames live in a
+// heap vector, so depth is bounded by Parser::max_depth, not by this list.
 class Layer {
 public:
-    std::string name;
-    std::string type;
+    Symbol name;
+    Symbol type;
     Parser* parser;
     int index;
 
-    Layer(std::string name, std::string layer_type, Parser* parser);
+    Layer(Symbol name, Symbol layer_type, Parser* parser);
     
-    Layer getAbove();
-    Layer getBelow();
+    Layer getAbove(); // caller
+    Layer getBelow(); // callee
 };
 
 }
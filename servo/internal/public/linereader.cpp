@@ -0,0 +1,75 @@
+#include "linereader.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace servo {
+
+LineReader::LineReader(int fd, bool owned) : fd(fd), owned(owned), buffer(chunk) {}
+
+LineReader::~LineReader() {
+    if (owned) ::close(fd);
+}
+
+std::unique_ptr<LineReader> LineReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return std::make_unique<LineReader>(fd, true);
+}
+
+LineReader& LineReader::standardInput() {
+    static LineReader reader(0);
+    return reader;
+}
+
+void LineReader::reset() {
+    begin = end = 0;
+    eof = false;
+}
+
+bool LineReader::next(std::string_view& line) {
+    size_t scanned = begin;
+    while (true) {
+        if (auto* nl = static_cast<char*>(std::memchr(buffer.data() + scanned, '\n', end - scanned))) {
+            size_t stop = nl - buffer.data();
+            line = std::string_view(buffer.data() + begin, stop - begin);
+            begin = stop + 1;
+            return true;
+        }
+        scanned = end;
+        if (eof) {
+            if (begin == end) return false;
+            line = std::string_view(buffer.data() + begin, end - begin); // last line, no '\n'
+            begin = end;
+            return true;
+        }
+        // Move the partial line to the front, growing only if it fills the buffer.
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            scanned -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+        ssize_t n = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::runtime_error(std::string("read failed: ") + std::strerror(errno));
+        if (n == 0) eof = true;
+        end += static_cast<size_t>(n);
+    }
+}
+
+bool LineReader::nextLocked(std::string& line) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string_view view;
+    if (!next(view)) return false;
+    line.assign(view);
+    return true;
+}
+
+}
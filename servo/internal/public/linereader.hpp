@@ -0,0 +1,51 @@
+#ifndef SERVO_INTERNAL_PUBLIC_LINEREADER_HPP
+#define SERVO_INTERNAL_PUBLIC_LINEREADER_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace servo {
+
+// Line-at-a-time reader over a file or stdin, for input() and
+// `for line in lines(...)`. Reads 1 MiB chunks into one reusable buffer
+// (grown only for longer lines), so memory stays constant however large
+// the input is.
+class LineReader {
+public:
+    static constexpr size_t chunk = 1 << 20;
+
+    explicit LineReader(int fd, bool owned = false);
+    ~LineReader();
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    static std::unique_ptr<LineReader> open(const std::string& path);
+    // Shared reader over fd 0, so input() and lines() see one stream.
+    static LineReader& standardInput();
+
+    // Next line without its '\n'; the view is valid until the next call.
+    // False at end of input.
+    bool next(std::string_view& line);
+    // next() under `mutex`, copied out before the lock is released. The stdin
+    // reader is read this way, a line at a time, so an input() inside a
+    // lines() loop (or a nested loop) takes its turn instead of deadlocking.
+    bool nextLocked(std::string& line);
+    // Forget buffered input (fd 0 is replaced between --serve requests).
+    void reset();
+
+    std::mutex mutex; // held for one line at a time, see nextLocked()
+
+private:
+    int fd;
+    bool owned;
+    bool eof = false;
+    std::vector<char> buffer;
+    size_t begin = 0, end = 0; // unread bytes
+};
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "output.hpp"
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace servo {
+
+Output::Output(int fd) : fd(fd), buffer(new char[capacity]) {}
+
+Output::~Output() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+Output& Output::out() {
+    static Output output(1);
+    return output;
+}
+
+Output& Output::err() {
+    static Output output(2);
+    return output;
+}
+
+void Output::flushAll() {
+    out().flush();
+    err().flush();
+}
+
+void Output::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+void Output::append(std::string_view data) {
+    if (used == 0) tty = isatty(fd); // fds may be redirected between flushes (--serve)
+    if (tty && data.find('\n') != std::string_view::npos) line_pending = true;
+    if (used + data.size() <= capacity) {
+        std::memcpy(buffer.get() + used, data.data(), data.size());
+        used += data.size();
+    } else {
+        flushLocked(data);
+    }
+}
+
+void Output::flushLocked(std::string_view extra) {
+    iovec iov[2] = {{buffer.get(), used}, {const_cast<char*>(extra.data()), extra.size()}};
+    int count = 2;
+    iovec* next = iov;
+    while (count > 0) {
+        if (next->iov_len == 0) { ++next; --count; continue; }
+        ssize_t n = ::writev(fd, next, count);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break; // closed pipe etc.: drop the output, as echo would
+        for (size_t done = static_cast<size_t>(n); done > 0 && count > 0;) {
+            size_t step = done < next->iov_len ? done : next->iov_len;
+            next->iov_base = static_cast<char*>(next->iov_base) + step;
+            next->iov_len -= step;
+            done -= step;
+            if (next->iov_len == 0) { ++next; --count; }
+        }
+    }
+    used = 0;
+    line_pending = false;
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef SERVO_INTERNAL_PUBLIC_OUTPUT_HPP
+#define SERVO_INTERNAL_PUBLIC_OUTPUT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace servo {
+
+// Buffered writer over a file descriptor, used by print / eprint.
+// Writes collect in a large buffer and go out with one writev when it fills
+// (a piece that does not fit is sent together with the buffer, uncopied).
+// The buffer is flushed on request, at exit, and after a newline when the
+// descriptor is a terminal.
+class Output {
+public:
+    static constexpr size_t capacity = 256 * 1024;
+
+    static Output& out(); // fd 1
+    static Output& err(); // fd 2
+    // Flush both; called before anything else writes to the descriptors
+    // (diagnostics, child processes, fd redirection).
+    static void flushAll();
+
+    // Holds the writer for a sequence of puts that must not interleave with
+    // other threads; the newline flush happens when it is released.
+    class Line {
+    public:
+        explicit Line(Output& output) : output(output), lock(output.mutex) {}
+        ~Line() { if (output.line_pending) output.flushLocked(); }
+        Line(const Line&) = delete;
+        Line& operator=(const Line&) = delete;
+        void put(std::string_view data) { output.append(data); }
+
+    private:
+        Output& output;
+        std::lock_guard<std::mutex> lock;
+    };
+
+    void write(std::string_view data) { Line(*this).put(data); }
+    void flush();
+
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+    ~Output();
+
+private:
+    explicit Output(int fd);
+
+    int fd;
+    std::mutex mutex;
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+    bool tty = false;          // checked when the buffer starts filling
+    bool line_pending = false; // tty and a newline was written
+
+    void append(std::string_view data);
+    void flushLocked(std::string_view extra = {});
+};
+
+}
+
+#endif
@@ -15,17 +15,7 @@ void ParsedMaterial::execute() {
             std::string name = "workspace.main"; // Placeholder logic 
             // In C++ reusing Safe::call properly with dynamic name might be tricky due to static file_name arg.
             // But Safe::call takes string.
-            try {
-                func();
-            } catch (const ReturnSignal&) {
-                // Only ignore top-level return signals for non-virtual files
-                // Virtual files (function bodies) should propagate ReturnSignal
-                if (this->parser->file.path != "virtual") {
-                    // Ignore for real files
-                } else {
-                    throw; // Re-throw for virtual files (function bodies)
-                }
-            }
+            func();
         }, "parsed_execution"); 
     } else {
         this->raw_execute();
@@ -7,6 +7,7 @@
 #include <cstdlib>
 #include <typeinfo>
 #include <cxxabi.h>
+#include "output.hpp"
 
 namespace servo {
 
@@ -25,12 +26,6 @@ public:
                 free(demangled);
             }
             
-            // Check if this is a ReturnSignal - if so, silently re-throw
-            // std::cerr << "DEBUG: error_name = " << error_name << std::endl;
-            if (error_name.find("ReturnSignal") != std::string::npos) {
-                throw;
-            }
-            
             // Basic formatting to match Python output style (approximated)
             std::string pretty_name = "";
             for (char c : error_name) {
@@ -43,6 +38,7 @@ public:
             size_t pos = pretty_name.find("ERROR");
             if (pos != std::string::npos) pretty_name.replace(pos, 5, "FATAL");
 
+            Output::flushAll(); // script output so far comes first
             std::cout << "\033[1m[servo@spp]\033[0;91m got '" << pretty_name << "' from function in '" 
                       << (file_name.empty() ? "<unknown>" : file_name) << "':\n      - " 
                       << error.what() << "\033[0m" << std::endl;
@@ -0,0 +1,200 @@
+#include "statement.hpp"
+#include "collection.hpp"
+#include "linereader.hpp"
+#include "../private/parser.hpp"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace servo {
+
+void Statement::execute(Parser* parser) {
+    switch (kind) {
+        case Kind::Expression: {
+            if (!block) {
+                expression->evaluate(parser);
+                return;
+            }
+            // Call with a trailing { ... } block: insert it at the callee's block argument.
+            auto callee = expression->resolve(parser);
+            if (!callee) throw std::runtime_error("variable '" + expression->name.str() + "' not found");
+            if (!callee->children.count("__block_arg_index")) {
+                throw std::runtime_error("'" + expression->name.str() + "' does not take a block");
+            }
+            size_t block_idx = std::any_cast<int>(callee->children["__block_arg_index"]->value);
+            auto& given = expression->children;
+            size_t count = std::max(given.size() + 1, block_idx + 1);
+            ArgFrame frame(count);
+            for (size_t i = 0, arg = 0; i < count; ++i) {
+                if (i == block_idx) frame[i] = block->value;
+                else if (arg < given.size()) frame[i] = given[arg++]->evaluate(parser);
+            }
+            std::any result;
+            expression->call(parser, frame.args(), result);
+            return;
+        }
+
+        case Kind::Assign: {
+            parser->assign(name, expression->evaluate(parser));
+            return;
+        }
+
+        case Kind::SetIndex: {
+            std::any val = expression->evaluate(parser);
+            std::any container = target->children[0]->evaluate(parser);
+            Expression::assignIndex(container, target->children[1]->evaluate(parser), std::move(val));
+            return;
+        }
+
+        case Kind::Return: {
+            // Parser::execute stops at the flag; the function call collects the value.
+            // The flag is raised only after evaluation: a recursive call made while
+            // evaluating runs in this same parser and clears it on exit.
+            if (!expression) {
+                parser->return_value.reset();
+                parser->returning = true;
+                return;
+            }
+            // Inside a function, a call in tail position (possibly behind the
+            // right-hand side of && / ||) is not made here: it is left pending so
+            // the caller runs it after this activation has unwound.
+            Expression* tail = expression.get();
+            bool to_boolean = false;
+            if (parser->activations > 0) {
+                while (tail->kind == Expression::Kind::Binary && (tail->op == Expression::Op::And || tail->op == Expression::Op::Or)) {
+                    bool lhs = Expression::truthy(tail->children[0]->evaluate(parser));
+                    if (lhs != (tail->op == Expression::Op::And)) {
+                        parser->return_value = Expression::boolean(lhs);
+                        parser->returning = true;
+                        return;
+                    }
+                    to_boolean = true;
+                    tail = tail->children[1].get();
+                }
+            }
+            if (parser->activations > 0 && tail->kind == Expression::Kind::Call) {
+                auto callee = tail->resolve(parser);
+                if (!callee) throw std::runtime_error("variable '" + tail->name.str() + "' not found");
+                ArgFrame args(tail->children.size());
+                for (size_t i = 0; i < tail->children.size(); ++i) args[i] = tail->children[i]->evaluate(parser);
+                parser->tail_args.resize(tail->children.size());
+                for (size_t i = 0; i < tail->children.size(); ++i) parser->tail_args[i] = std::move(args[i]);
+                parser->tail_callee = std::move(callee);
+                parser->tail_boolean = to_boolean;
+                parser->returning = true;
+                return;
+            }
+            std::any value = tail->evaluate(parser);
+            parser->return_value = to_boolean ? Expression::boolean(Expression::truthy(value)) : std::move(value);
+            parser->returning = true;
+            return;
+        }
+
+        case Kind::Import:
+            if (lazy || Parser::lazy_imports) parser->bindLazyModule(name.str());
+            else parser->importModule(name.str());
+            return;
+
+        case Kind::While:
+            // Each iteration is a condition check and a walk over the compiled body.
+            while (Expression::truthy(expression->evaluate(parser))) {
+                for (auto& stmt : body) {
+                    stmt->execute(parser);
+                    if (parser->returning) return;
+                }
+            }
+            return;
+
+        case Kind::For:
+            runFor(parser);
+            return;
+    }
+}
+
+void Statement::runFor(Parser* parser) {
+    if (expression->kind != Expression::Kind::Call) return runEach(parser);
+    if (expression->name == Symbol("lines")) return runLines(parser);
+    if (expression->name != Symbol("range")) return runEach(parser);
+    long long bounds[3] = {0, 0, 1}; // start, stop, step
+    auto& given = expression->children;
+    for (size_t i = 0; i < given.size(); ++i) {
+        String text = Expression::toString(given[i]->evaluate(parser));
+        auto view = text.view();
+        long long value;
+        auto [end, ec] = std::from_chars(view.data(), view.data() + view.size(), value);
+        if (ec != std::errc() || end != view.data() + view.size()) {
+            throw std::runtime_error("range() expects integers, got '" + text.str() + "'");
+        }
+        bounds[given.size() == 1 ? 1 : i] = value;
+    }
+    long long start = bounds[0], stop = bounds[1], step = bounds[2];
+    if (step == 0) throw std::runtime_error("range() step must not be zero");
+
+    // The loop variable is one Variable bound once and updated in place; it is
+    // re-bound only if the body rebinds the name. Nothing is materialized.
+    auto slot = std::make_shared<Variable>(name, String(), "int", std::map<Symbol, std::shared_ptr<Variable>>{}, parser);
+    parser->bind(name, slot);
+    for (long long i = start; step > 0 ? i < stop : i > stop; i += step) {
+        slot->value = String(std::to_string(i));
+        auto it = parser->pool.find(name);
+        if (it == parser->pool.end() || it->second != slot) parser->bind(name, slot);
+        for (auto& stmt : body) {
+            stmt->execute(parser);
+            if (parser->returning) return;
+        }
+    }
+}
+
+void Statement::runLines(Parser* parser) {
+    std::string source = expression->children.empty() ? "-" : Expression::toString(expression->children[0]->evaluate(parser)).str();
+    std::unique_ptr<LineReader> file;
+    LineReader* reader;
+    if (source == "-" || source.empty()) {
+        reader = &LineReader::standardInput(); // shared with input(): locked per line
+    } else {
+        file = LineReader::open(source);
+        reader = file.get();
+    }
+
+    // As in runFor, one slot Variable; only the current line is held.
+    auto slot = std::make_shared<Variable>(name, String(), "String", std::map<Symbol, std::shared_ptr<Variable>>{}, parser);
+    parser->bind(name, slot);
+    std::string line;
+    while (reader->nextLocked(line)) {
+        slot->value = String(std::move(line));
+        auto it = parser->pool.find(name);
+        if (it == parser->pool.end() || it->second != slot) parser->bind(name, slot);
+        for (auto& stmt : body) {
+            stmt->execute(parser);
+            if (parser->returning) return;
+        }
+    }
+}
+
+void Statement::runEach(Parser* parser) {
+    std::any iterable = expression->evaluate(parser);
+    auto* list = std::any_cast<List>(&iterable);
+    auto* map = std::any_cast<Map>(&iterable);
+    if (!list && !map) {
+        throw std::runtime_error("for expects range(), lines(), a list or a map, got '" + Expression::toString(iterable).str() + "'");
+    }
+
+    // Lists are walked by index, so appends made by the body are visited;
+    // maps yield a snapshot of their keys.
+    std::vector<String> keys;
+    if (map) keys = map->keys();
+    auto slot = std::make_shared<Variable>(name, String(), "String", std::map<Symbol, std::shared_ptr<Variable>>{}, parser);
+    parser->bind(name, slot);
+    for (size_t i = 0; list ? i < list->size() : i < keys.size(); ++i) {
+        if (list) slot->value = list->items()[i];
+        else slot->value = keys[i];
+        auto it = parser->pool.find(name);
+        if (it == parser->pool.end() || it->second != slot) parser->bind(name, slot);
+        for (auto& stmt : body) {
+            stmt->execute(parser);
+            if (parser->returning) return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,39 @@
+#ifndef SERVO_INTERNAL_PUBLIC_STATEMENT_HPP
+#define SERVO_INTERNAL_PUBLIC_STATEMENT_HPP
+
+#include <memory>
+#include <vector>
+#include "expression.hpp"
+#include "symbol.hpp"
+
+namespace servo {
+
+class Parser;
+class Variable;
+
+// One compiled statement of a script, function body or loop body.
+class Statement {
+public:
+    enum class Kind { Expression, Assign, SetIndex, Return, Import, While, For };
+
+    Kind kind;
+    Symbol name; // Assign target / Import module / For variable
+    std::shared_ptr<servo::Expression> expression; // While: condition; For: range(...) / lines(...) call or a list / map
+    std::shared_ptr<servo::Expression> target; // SetIndex: the container[key] being assigned
+    std::shared_ptr<Variable> block; // block passed to a call statement, if any
+    std::vector<std::shared_ptr<Statement>> body; // While / For
+    bool lazy = false; // Import: `<import lazy name>`
+
+    Statement(Kind kind) : kind(kind) {}
+
+    void execute(Parser* parser);
+
+private:
+    void runFor(Parser* parser);
+    void runLines(Parser* parser);
+    void runEach(Parser* parser);
+};
+
+}
+
+#endif
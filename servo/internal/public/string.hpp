@@ -2,37 +2,132 @@
 #define SERVO_INTERNAL_PUBLIC_STRING_HPP
 
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <memory>
+#include <atomic>
+#include "symbol.hpp"
 
 namespace servo {
 
-class String : public std::string {
+// Immutable string value. Copies share one buffer, and strings built from a
+// Symbol share the interner's buffer, so repeated literals never reallocate.
+//
+// A String is a prefix [0, length) of its buffer. Concatenation results own a
+// growable builder buffer: appending to the String that ends at the buffer's
+// current end extends the buffer in place instead of copying it, so chains like
+// a + b + c and repeated `s = s + x` run in amortized linear time. Older Strings
+// over the same buffer keep seeing their own (unchanged) prefix.
+//
+// The handle itself is one pointer to a refcounted Rep, which keeps it inside
+// std::any's in-place storage: copying a value never allocates.
+class String {
 public:
-    using std::string::string;
-    String(const std::string& s) : std::string(s) {}
-    String(const char* s) : std::string(s) {}
-    String(int i) : std::string(std::to_string(i)) {}
-    String(double d) : std::string(std::to_string(d)) {}
+    String() : rep(emptyRep()) { retain(); }
+    String(const std::string& s) : rep(new Rep(std::make_shared<const std::string>(s), s.size(), false)) {}
+    String(std::string&& s) : rep(nullptr) {
+        size_t length = s.size();
+        rep = new Rep(std::make_shared<const std::string>(std::move(s)), length, false);
+    }
+    String(const char* s) : String(std::string(s)) {}
+    String(int i) : String(std::to_string(i)) {}
+    String(double d) : String(std::to_string(d)) {}
+    explicit String(Symbol sym) : rep(new Rep(sym.buffer(), sym.str().size(), false)) {}
+
+    String(const String& other) noexcept : rep(other.rep) { retain(); }
+    // The moved-from String is left empty, not null, so it stays usable.
+    String(String&& other) noexcept : rep(other.rep) {
+        other.rep = emptyRep();
+        other.retain();
+    }
+    String& operator=(const String& other) noexcept {
+        if (rep != other.rep) {
+            String copy(other);
+            std::swap(rep, copy.rep);
+        }
+        return *this;
+    }
+    String& operator=(String&& other) noexcept {
+        std::swap(rep, other.rep);
+        return *this;
+    }
+    ~String() { release(); }
+
+    std::string_view view() const { return std::string_view(rep->data->data(), rep->length); }
+    std::string str() const { return std::string(view()); }
+    operator std::string_view() const { return view(); }
+    size_t size() const { return rep->length; }
+    bool empty() const { return rep->length == 0; }
+
+    String append(std::string_view other) const;
 
     template<typename T>
     String operator+(const T& other) const {
-        return String(static_cast<std::string>(*this) + std::to_string(other)); // Simplified
+        return append(std::to_string(other)); // Simplified
     }
-    
+
     // Concatenation with string
-    String operator+(const std::string& other) const {
-        return String(static_cast<std::string>(*this) + other);
-    }
-    String operator+(const char* other) const {
-        return String(static_cast<std::string>(*this) + other);
+    String operator+(const std::string& other) const { return append(other); }
+    String operator+(const char* other) const { return append(other); }
+    String operator+(std::string_view other) const { return append(other); }
+    String operator+(const String& other) const { return append(other.view()); }
+
+    bool operator==(const String& other) const {
+        return rep == other.rep || view() == other.view();
     }
+    bool operator!=(const String& other) const { return !(*this == other); }
 
     friend std::ostream& operator<<(std::ostream& os, const String& s) {
-        os << static_cast<std::string>(s);
+        os << s.view();
         return os;
     }
+
+private:
+    struct Rep {
+        std::atomic<uint32_t> refs{1};
+        std::shared_ptr<const std::string> data;
+        size_t length;
+        bool builder; // data was allocated by append() and may grow in place
+
+        Rep(std::shared_ptr<const std::string> d, size_t l, bool b) : data(std::move(d)), length(l), builder(b) {}
+    };
+
+    Rep* rep;
+
+    static Rep* emptyRep() {
+        // Never freed: the static holds one reference forever.
+        static Rep* rep = new Rep(Symbol().buffer(), 0, false);
+        return rep;
+    }
+    void retain() const { rep->refs.fetch_add(1, std::memory_order_relaxed); }
+    void release() {
+        if (rep->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete rep;
+    }
 };
 
+static_assert(sizeof(String) == sizeof(void*), "String must fit std::any's in-place storage");
+
+inline String String::append(std::string_view other) const {
+    std::shared_ptr<const std::string> data;
+    if (rep->builder && rep->length == rep->data->size()) {
+        // Fast path: we are the newest prefix of a builder buffer; grow it.
+        // The buffer was created non-const by append(), so writing through it is valid.
+        auto& bytes = const_cast<std::string&>(*rep->data);
+        bytes.append(other.data(), other.size());
+        data = rep->data;
+    } else {
+        auto bytes = std::make_shared<std::string>();
+        bytes->reserve(2 * (rep->length + other.size()));
+        bytes->append(view());
+        bytes->append(other.data(), other.size());
+        data = std::move(bytes);
+    }
+    String result;
+    result.release();
+    result.rep = new Rep(std::move(data), rep->length + other.size(), true);
+    return result;
+}
+
 }
 
 #endif
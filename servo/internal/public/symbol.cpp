@@ -0,0 +1,64 @@
+#include "symbol.hpp"
+#include <mutex>
+#include <stdexcept>
+
+namespace servo {
+
+Symbol::Symbol(const std::string& text) : id(Interner::get().intern(text)) {}
+Symbol::Symbol(const char* text) : id(Interner::get().intern(text)) {}
+Symbol::Symbol(std::string_view text) : id(Interner::get().intern(text)) {}
+
+const std::string& Symbol::str() const {
+    return Interner::get().text(this->id);
+}
+
+std::shared_ptr<const std::string> Symbol::buffer() const {
+    return Interner::get().buffer(this->id);
+}
+
+uint32_t Symbol::version() const {
+    return Interner::get().version(this->id);
+}
+
+void Symbol::touch() const {
+    Interner::get().touch(this->id);
+}
+
+Interner& Interner::get() {
+    static Interner instance;
+    return instance;
+}
+
+Interner::Interner() {
+    // Reserve id 0 for the empty string so a default Symbol is valid.
+    intern("");
+}
+
+uint32_t Interner::intern(std::string_view text) {
+    uint32_t id;
+    if (find(text, id)) return id;
+
+    std::unique_lock<std::shared_mutex> guard(lock);
+    auto it = ids.find(text); // another thread may have won the race
+    if (it != ids.end()) return it->second;
+
+    id = count.load(std::memory_order_relaxed);
+    if ((id >> chunk_bits) >= max_chunks) throw std::length_error("symbol table is full");
+    auto& chunk = chunks[id >> chunk_bits];
+    if (!chunk) chunk.reset(new Entry[chunk_size]);
+    Entry& e = chunk[id & (chunk_size - 1)];
+    e.buffer = std::make_shared<const std::string>(text);
+    ids.emplace(std::string_view(*e.buffer), id);
+    count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+bool Interner::find(std::string_view text, uint32_t& id) const {
+    std::shared_lock<std::shared_mutex> guard(lock);
+    auto it = ids.find(text);
+    if (it == ids.end()) return false;
+    id = it->second;
+    return true;
+}
+
+}
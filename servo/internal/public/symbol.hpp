@@ -0,0 +1,87 @@
+#ifndef SERVO_INTERNAL_PUBLIC_SYMBOL_HPP
+#define SERVO_INTERNAL_PUBLIC_SYMBOL_HPP
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <functional>
+#include <atomic>
+#include <shared_mutex>
+
+namespace servo {
+
+// Compact handle for an interned identifier or string constant.
+// Two symbols are equal iff their text is equal, so comparisons are integer compares.
+class Symbol {
+public:
+    uint32_t id = 0; // 0 is always the empty string
+
+    Symbol() = default;
+    Symbol(const std::string& text);
+    Symbol(const char* text);
+    Symbol(std::string_view text);
+
+    const std::string& str() const;
+    std::shared_ptr<const std::string> buffer() const;
+
+    // Binding version: bumped whenever any pool rebinds this name, so caches
+    // that resolved the name can tell when their result may be stale.
+    uint32_t version() const;
+    void touch() const;
+
+    bool operator==(const Symbol& other) const { return id == other.id; }
+    bool operator!=(const Symbol& other) const { return id != other.id; }
+    bool operator<(const Symbol& other) const { return id < other.id; }
+};
+
+// Global symbol table. Every distinct text is stored once in an immutable buffer,
+// which is also shared by String values created from the symbol.
+//
+// Thread-safe: interning and text lookup take a reader/writer lock, while
+// entries live in fixed chunks that never move, so reading a known id's text or
+// version needs no lock.
+class Interner {
+public:
+    static Interner& get();
+
+    uint32_t intern(std::string_view text);
+    // Lookup without inserting; returns false when the text was never interned.
+    bool find(std::string_view text, uint32_t& id) const;
+    const std::string& text(uint32_t id) const { return *entry(id).buffer; }
+    std::shared_ptr<const std::string> buffer(uint32_t id) const { return entry(id).buffer; }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+    uint32_t version(uint32_t id) const { return entry(id).version.load(std::memory_order_relaxed); }
+    void touch(uint32_t id) { entry(id).version.fetch_add(1, std::memory_order_relaxed); }
+    // Stable for the life of the process; lets generated code guard on a version.
+    const std::atomic<uint32_t>* versionAddress(uint32_t id) const { return &entry(id).version; }
+
+private:
+    Interner();
+
+    static constexpr uint32_t chunk_bits = 12;
+    static constexpr uint32_t chunk_size = 1u << chunk_bits;
+    static constexpr uint32_t max_chunks = 4096; // 16M symbols
+
+    struct Entry {
+        std::shared_ptr<const std::string> buffer;
+        std::atomic<uint32_t> version{0};
+    };
+    Entry& entry(uint32_t id) const { return chunks[id >> chunk_bits][id & (chunk_size - 1)]; }
+
+    std::unique_ptr<Entry[]> chunks[max_chunks];
+    std::atomic<uint32_t> count{0};
+    mutable std::shared_mutex lock;
+    std::unordered_map<std::string_view, uint32_t> ids; // views point into buffers
+};
+
+}
+
+namespace std {
+template<> struct hash<servo::Symbol> {
+    size_t operator()(const servo::Symbol& s) const noexcept { return s.id; }
+};
+}
+
+#endif
@@ -5,19 +5,51 @@
 
 namespace servo {
 
-std::any Variable::call(std::vector<std::any> args) {
-    if (this->value.type() == typeid(std::function<std::any(std::vector<std::any>)>)) {
-        auto func = std::any_cast<std::function<std::any(std::vector<std::any>)>>(this->value);
-        return func(args);
-    } else if (this->value.type() == typeid(std::function<void(std::string)>)) {
-         // Handle system calls mapping?
-         // Builtins.system takes string.
-         // If args is vector, convert to string?
-         // This is getting tricky due to type erasure.
-         // Assuming specialized handling in parser or uniform wrapper.
-         throw std::runtime_error("Variable is not callable (type mismatch)");
+void Variable::call(Args args, std::any& result) {
+    // Pointer any_cast: invoke the stored function in place instead of copying it out.
+    if (auto* native = std::any_cast<NativeFunction>(&this->value)) {
+        (*native)(args, result);
+        return;
     }
-    throw std::runtime_error("Variable '" + this->name + "' is not callable");
+    if (auto* func = std::any_cast<Callable>(&this->value)) {
+        invoke(*func, args, result);
+        return;
+    }
+    throw std::runtime_error("Variable '" + this->name.str() + "' is not callable");
+}
+
+void Variable::invoke(const Callable& func, Args args, std::any& result) {
+    func(args, result);
+    if (result.type() != typeid(TailCall)) return;
+
+    // Trampoline. Arguments move between this vector and the frame's, so
+    // steady-state iteration reuses both buffers.
+    std::vector<std::any> tail_args;
+    bool to_boolean = false;
+    while (auto* tail = std::any_cast<TailCall>(&result)) {
+        Parser* frame = tail->frame;
+        auto callee = std::move(frame->tail_callee);
+        to_boolean |= frame->tail_boolean;
+        tail_args.swap(frame->tail_args);
+        frame->tail_args.clear();
+        result.reset();
+
+        if (auto* native = std::any_cast<NativeFunction>(&callee->value)) {
+            (*native)(Args(tail_args), result);
+            continue;
+        }
+        auto* next = std::any_cast<Callable>(&callee->value);
+        if (!next) throw std::runtime_error("Variable '" + callee->name.str() + "' is not callable");
+        (*next)(Args(tail_args), result);
+    }
+    // `return c && f(x)` yields a boolean; repeated conversion is idempotent.
+    if (to_boolean) result = Expression::boolean(Expression::truthy(result));
+}
+
+std::any Variable::call(const std::vector<std::any>& args) {
+    std::any result;
+    this->call(Args(args), result);
+    return result;
 }
 
 }
@@ -6,26 +6,83 @@
 #include <map>
 #include <memory>
 #include <vector>
+#include <functional>
 #include "safe.hpp"
+#include "symbol.hpp"
 
 namespace servo {
 
 class Parser;
 
+// Arguments of a call: a read-only view over values owned by the caller.
+class Args {
+public:
+    Args() = default;
+    Args(const std::any* data, size_t count) : ptr(data), count(count) {}
+    Args(const std::vector<std::any>& values) : ptr(values.data()), count(values.size()) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const std::any& operator[](size_t i) const { return ptr[i]; }
+    const std::any* begin() const { return ptr; }
+    const std::any* end() const { return ptr + count; }
+
+private:
+    const std::any* ptr = nullptr;
+    size_t count = 0;
+};
+
+// Caller-owned argument storage, on the caller's C++ stack for up to 8 values.
+class ArgFrame {
+public:
+    static constexpr size_t inline_capacity = 8;
+
+    explicit ArgFrame(size_t count) : count(count) {
+        if (count > inline_capacity) heap.resize(count);
+    }
+
+    std::any& operator[](size_t i) { return heap.empty() ? slots[i] : heap[i]; }
+    Args args() const { return Args(heap.empty() ? slots : heap.data(), count); }
+
+private:
+    std::any slots[inline_capacity];
+    std::vector<std::any> heap;
+    size_t count;
+};
+
+// Native and user functions are stored in Variable::value as this type.
+// Arguments are borrowed from the caller and the result is written into the
+// caller's slot, so a call itself copies nothing and allocates nothing.
+using Callable = std::function<void(Args, std::any&)>;
+// Stateless natives (see binding.hpp) are stored as a plain function pointer
+// and called directly, without std::function's indirection.
+using NativeFunction = void (*)(Args, std::any&);
+
+// Result of a user function whose body ended in `return g(...)`: the function
+// has already unwound its own activation and left the pending call (callee and
+// evaluated arguments) in `frame`. Variable::invoke runs it, so chains of tail
+// calls execute one after another instead of nesting on the C++ stack.
+struct TailCall {
+    Parser* frame;
+};
+
 class Variable {
 public:
-    std::string name;
+    Symbol name;
     std::any value;
     std::string value_type;
-    std::map<std::string, std::shared_ptr<Variable>> children;
+    std::map<Symbol, std::shared_ptr<Variable>> children;
     Parser* parser;
 
-    Variable(std::string n, std::any v, std::string t, std::map<std::string, std::shared_ptr<Variable>> c, Parser* p)
+    Variable(Symbol n, std::any v, std::string t, std::map<Symbol, std::shared_ptr<Variable>> c, Parser* p)
         : name(n), value(v), value_type(t), children(c), parser(p) {}
     
     Variable() = default;
 
-    std::any call(std::vector<std::any> args = {}); // Adjusted signature for C++
+    void call(Args args, std::any& result);
+    // Call `func` and run any tail calls it hands back until a value results.
+    static void invoke(const Callable& func, Args args, std::any& result);
+    std::any call(const std::vector<std::any>& args = {}); // convenience for native callers
 };
 
 }
@@ -1,29 +1,65 @@
 #include "internal/private/parser.hpp"
+#include "internal/private/jit.hpp"
+#include "internal/private/memo.hpp"
+#include "internal/private/runner.hpp"
+#include "internal/private/server.hpp"
 #include <iostream>
+#include <unistd.h>
 
 int main(int argc, char* argv[]) {
     // Mimic servo/__main__.py logic roughly
-    if (argc < 2) {
+    // simple arg handling: flags may come before or after the script path;
+    // other words after the script path are passed to the script as args
+    std::string path;
+    std::string source; // -e: inline script
+    bool has_source = false;
+    std::vector<std::string> script_args;
+    std::string batch;
+    int jobs = 0; // 0: the mode's default
+    bool serve = false, client = false, watch = false, emit_cpp = false;
+    std::string socket_path = servo::Server::defaultSocket();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-O0") servo::Parser::optimize_level = 0;
+        else if (arg == "-O1") servo::Parser::optimize_level = 1;
+        else if (arg == "--batch" && i + 1 < argc) batch = argv[++i];
+        else if (arg == "-j" && i + 1 < argc) jobs = std::atoi(argv[++i]);
+        else if (arg.rfind("-j", 0) == 0 && arg.size() > 2) jobs = std::atoi(arg.c_str() + 2);
+        else if (arg == "--jit") servo::Jit::enabled = true;
+        else if (arg == "--stats") servo::Memo::stats = true;
+        else if (arg == "--lazy-imports") servo::Parser::lazy_imports = true;
+        else if (arg == "--max-depth" && i + 1 < argc) servo::Parser::max_depth = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--serve") serve = true;
+        else if (arg == "--watch") watch = true;
+        else if (arg == "--emit-cpp") emit_cpp = true;
+        else if (arg == "--client") client = true;
+        else if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+        else if (arg == "-e" && i + 1 < argc) { source = argv[++i]; has_source = true; }
+        else if (path.empty() && !has_source) path = arg;
+        else script_args.push_back(arg);
+    }
+    if (serve) return servo::Server::serve(socket_path, jobs > 0 ? jobs : 4);
+    if (!batch.empty()) {
+        int status = servo::Runner::runBatch(batch, jobs > 0 ? jobs : 1);
+        if (servo::Memo::stats) servo::Memo::report(std::cerr);
+        return status;
+    }
+    if (path.empty() && !has_source) {
         std::cerr << "\033[1m[servo@spp]\033[0;91m please provide a servo file as argument 1.\033[0m" << std::endl;
         return 1;
     }
-    // simple arg handling
-    std::string path = argv[1];
-    servo::File f(path, true); // no_read=True initially?
-    // python code: Parser(File(..., no_read=True))
-    // then check file type
-    if (f.getType() != "file") {
-         std::cerr << "\033[1m[servo@spp]\033[0;91m tried to run servo file that is a directory or does not exist:\n        - " << f.getPath() << "\033[0m" << std::endl;
-         return 1;
-    }
-    f.read();
-    
-    servo::Parser p(f);
-    try {
-        p.parse().execute();
-    } catch (const std::exception& e) {
-        // Safe wrapper usually handles printing, but main might catch top level
-        return 1; 
+    if (client) {
+        servo::Server::Request request;
+        char cwd[4096];
+        request.cwd = getcwd(cwd, sizeof(cwd)) ? cwd : ".";
+        request.inline_source = has_source;
+        request.script = has_source ? source : path;
+        request.args = script_args;
+        return servo::Server::client(socket_path, request);
     }
-    return 0;
+    if (emit_cpp && !has_source) return servo::Runner::emitCpp(path);
+    if (watch && !has_source) return servo::Runner::watch(path, script_args);
+    int status = has_source ? servo::Runner::runSource(source, script_args) : servo::Runner::runFile(path, script_args);
+    if (servo::Memo::stats) servo::Memo::report(std::cerr);
+    return status;
 }
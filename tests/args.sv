@@ -0,0 +1,4 @@
+# args: one two
+print(args.count)
+print(args.0 + " " + args.1)
+print(args.5)
@@ -0,0 +1,41 @@
+# Reassigning a name updates it in place; each call still keeps its own locals.
+fn count(n) {
+    i = 0
+    s = 0
+    while i < n {
+        s = s + i
+        i = i + 1
+    }
+    return s
+}
+print(count(100))
+
+# A recursive call assigns the same local names as its caller.
+fn depth(n) {
+    x = n
+    while n > 0 {
+        inner = depth(n - 1)
+        x = x + "<" + inner
+        return x
+    }
+    return x
+}
+print(depth(3))
+
+# Assigning inside a function does not change an outer name.
+g = "global"
+fn shadow() {
+    g = "local"
+    g = g + "!"
+    return g
+}
+print(shadow())
+print(g)
+g = g + " again"
+print(g)
+
+# A loop variable reassigned in the body is set again by the next iteration.
+for k in range(3) {
+    k = k * 10
+    print(k)
+}
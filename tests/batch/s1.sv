@@ -0,0 +1,3 @@
+<import counter>
+print("s1 " + counter.add(1))
+print(counter.items)
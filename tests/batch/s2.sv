@@ -0,0 +1,3 @@
+<import counter>
+print("s2 " + counter.add(2))
+print(counter.items)
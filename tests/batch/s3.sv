@@ -0,0 +1,3 @@
+<import counter>
+print("s3 " + counter.add(3))
+print(counter.items)
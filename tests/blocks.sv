@@ -0,0 +1,18 @@
+# no-aot
+# Blocks passed to functions as anonymous function values.
+fn each(n, {body}) {
+    for i in range(n) {
+        body()
+    }
+}
+fn outer(k) {
+    total = [0]
+    each(k) {
+        total[0] = total[0] + 1
+    }
+    return total[0]
+}
+print(outer(3))
+each(2) {
+    print("hi")
+}
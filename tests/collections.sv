@@ -0,0 +1,26 @@
+# Lists and maps.
+l = [1, 2, 3]
+append(l, 4)
+print(l)
+print(len(l) + " " + l[0] + " " + l[3])
+l[1] = "two"
+print(l)
+print(pop(l))
+print(l)
+m = {"a": 1, "b": [2, 3]}
+m["c"] = 5
+print(m)
+print(keys(m))
+print(values(m))
+print(has(m, "a") + " " + has(m, "z") + " " + ("b" in m) + " " + (3 in l))
+remove(m, "a")
+print(m)
+for k in m {
+    print(k)
+}
+for v in [5, 6] {
+    print(v * 2)
+}
+print(l == l)
+print([1] == [1])
+print(l[7])
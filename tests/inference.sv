@@ -0,0 +1,20 @@
+# Functions hot enough for --jit whose types inference has to get right:
+# integer and float locals, results that print as integers, and overflow.
+fn damp(n, x) {
+    for i in range(n) {
+        x = x * 0.5 + 0.37
+    }
+    return x
+}
+fn half(x) {
+    return x / 2
+}
+fn square(x) {
+    return x * x
+}
+for r in range(12) {
+    print(damp(r, 1.5) + " " + half(r) + " " + half(r + 0.5) + " " + square(r))
+}
+print(damp(100, 3))
+print(half(4.0) + " " + half(0.1 + 0.2))
+print(square(3037000499) + " " + square(3037000500))
@@ -0,0 +1,10 @@
+# input() and lines() share stdin a line at a time, even when nested.
+print(input("> "))
+for l in lines() {
+    x = input()
+    print(l + " then " + x)
+    for m in lines() {
+        print("  inner " + m)
+    }
+}
+print("end [" + input() + "]")
@@ -0,0 +1,31 @@
+# while and for-in-range loops, inside functions and at top level.
+fn fib(n) {
+    while n < 2 {
+        return n
+    }
+    return fib(n - 1) + fib(n - 2)
+}
+fn sumsq(n) {
+    s = 0
+    for i in range(n) {
+        s = s + i * i % 7 - i / 3
+    }
+    return s
+}
+fn nothing(n) {
+    x = n
+}
+for r in range(12) {
+    print(fib(r) + " " + sumsq(r * 10) + " [" + nothing(r) + "]")
+}
+print(fib(20))
+print(sumsq(10000))
+print(fib("3"))
+for i in range(10, 0, -3) {
+    print(i)
+}
+i = 0
+while i < 3 {
+    i = i + 1
+}
+print(i)
@@ -0,0 +1,36 @@
+# no-aot
+# `memo fn`: results are cached by argument text only.
+memo fn fib(n) {
+    while n < 2 {
+        return n
+    }
+    return fib(n - 1) + fib(n - 2)
+}
+print(fib(60))
+
+# Blocks have no text, so calls with different blocks are not conflated.
+memo fn run(x, {body}) {
+    body()
+    return x
+}
+run(2) {
+    print("first block")
+}
+run(2) {
+    print("second block")
+}
+
+# A cached list would be shared by every caller.
+memo fn fresh(n) {
+    return [n]
+}
+a = fresh(1)
+a[0] = 99
+print(fresh(1))
+
+# Same text, different argument split.
+memo fn pair(a, b) {
+    return a + "|" + b
+}
+print(pair("a,b", "c"))
+print(pair("a", "b,c"))
@@ -0,0 +1,56 @@
+# Number semantics: values are text, arithmetic reads them as integers or floats.
+print(1 + 2 * 3)
+print((1 + 2) * 3)
+print(7 / 2)
+print(-7 / 2)
+print(7 % 3)
+print(7.0 / 2)
+print(0.1 + 0.2)
+print(1.5 * 2)
+print(2 ^ 10)
+print(2 ^ 3 ^ 2)
+print(-2 ^ 2)
+print(10 - 2 - 3)
+print("a" + 1)
+print(1 + "a")
+print("007" + 1)
+print(3 < 10)
+print("3" < "10")
+print("abc" < "abd")
+print(2 == 2.0)
+print(!0)
+print(!"")
+print(1 && 0 || 2)
+x = 60 * 60 * 24
+print(x)
+print(x / 7)
+# Integer overflow turns into floats, printed in exponent form, which still read back as numbers.
+z = 9223372036854775807
+print(z + 1)
+print(z + 1 + 1)
+print((z + 1) * 3)
+print(-z - 2)
+y = 0.5 * 10000000000000000
+print(y)
+print(y + 1)
+print(y / 2 > 1000)
+print(1.5e3 + 1)
+print(2E-3 * 2)
+print(1e20 / 1e5)
+print(0.00001 * 3)
+print("1e5" + 1)
+print("e5" + 1)
+one = 1
+print(one ^ 9000000000000000000)
+print(1 ^ 9000000000000000000)
+minus = 0 - 1
+print(minus ^ 9000000000000000001)
+print(0 ^ 9000000000000000000)
+print(0 ^ 0)
+print(2 ^ 62)
+two = 0 - 2
+print(two ^ 63)
+print(two ^ 64)
+print(2 ^ 63)
+print(3 ^ 39)
+print(3 ^ 40)
@@ -0,0 +1,7 @@
+# Stateful module for the batch and serve isolation tests.
+print("loading counter")
+items = []
+fn add(x) {
+    append(items, x)
+    return len(items)
+}
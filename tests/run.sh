@@ -0,0 +1,91 @@
+#!/bin/sh
+# Script-level tests, run by `make test` from the repository root.
+#
+# tests/<name>.sv is run and its stdout, followed by "exit <status>", is
+# compared with tests/<name>.out. Unless the script says otherwise in a
+# leading comment, it is also run with --jit and built with --emit-cpp, and
+# both must produce the same output:
+#   # args: a b      arguments passed to the script
+#   # no-aot         uses something --emit-cpp does not support
+# tests/<name>.in, when present, is the script's stdin (otherwise empty).
+# tests/<name>.batch lists scripts for `--batch <list> -j 1`, run from
+# tests/ (so modules in tests/reach/ import); its stdout is compared with
+# tests/<name>.out the same way, and so is the output of sending the same
+# scripts in turn to one `--serve -j 1` worker with --client.
+
+cd "$(dirname "$0")/.." || exit 1
+tmp=$(mktemp -d "${TMPDIR:-/tmp}/servo-tests.XXXXXX") || exit 1
+trap 'rm -rf "$tmp"' EXIT
+failed=0
+passed=0
+
+check() { # name, mode, expected, actual
+    if cmp -s "$3" "$4"; then
+        passed=$((passed + 1))
+    else
+        echo "FAIL $1 ($2)"
+        diff "$3" "$4" | head -20
+        failed=$((failed + 1))
+    fi
+}
+
+run() { # output file, command...
+    out=$1
+    shift
+    "$@" > "$out" 2> /dev/null < "$stdin"
+    echo "exit $?" >> "$out"
+}
+
+for script in tests/*.sv; do
+    name=$(basename "$script" .sv)
+    expected=tests/$name.out
+    args=$(sed -n 's/^# args: //p' "$script")
+    stdin=tests/$name.in
+    [ -e "$stdin" ] || stdin=/dev/null
+
+    run "$tmp/$name.interp" ./servocomp "$script" $args
+    check "$name" interpreter "$expected" "$tmp/$name.interp"
+    run "$tmp/$name.jit" ./servocomp --jit "$script" $args
+    check "$name" --jit "$expected" "$tmp/$name.jit"
+
+    if ! grep -q '^# no-aot' "$script"; then
+        cp "$script" "$tmp/$name.sv"
+        if make -s "$tmp/$name.aot" > "$tmp/$name.build" 2>&1; then
+            run "$tmp/$name.aotout" "$tmp/$name.aot" $args
+            check "$name" --emit-cpp "$expected" "$tmp/$name.aotout"
+        else
+            echo "FAIL $name (--emit-cpp build)"
+            head -20 "$tmp/$name.build"
+            failed=$((failed + 1))
+        fi
+    fi
+done
+
+stdin=/dev/null
+for list in tests/*.batch; do
+    [ -e "$list" ] || continue
+    name=$(basename "$list" .batch)
+    run "$tmp/$name.batch" sh -c "cd tests && ../servocomp --batch $name.batch -j 1"
+    check "$name" --batch "tests/$name.out" "$tmp/$name.batch"
+done
+
+if ls tests/*.batch > /dev/null 2>&1; then
+    ./servocomp --serve --socket "$tmp/sock" -j 1 2> /dev/null &
+    server=$!
+    for i in 1 2 3 4 5 6 7 8 9 10; do
+        [ -S "$tmp/sock" ] && break
+        sleep 0.2
+    done
+    for list in tests/*.batch; do
+        name=$(basename "$list" .batch)
+        run "$tmp/$name.serve" sh -c "cd tests && grep -v '^#' $name.batch | while read -r script; do
+            ../servocomp --client --socket '$tmp/sock' \"\$script\" || exit
+        done"
+        check "$name" --serve "tests/$name.out" "$tmp/$name.serve"
+    done
+    kill "$server"
+    wait "$server" 2> /dev/null
+fi
+
+echo "$passed passed, $failed failed"
+[ "$failed" -eq 0 ]
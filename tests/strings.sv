@@ -0,0 +1,8 @@
+# The system_string module.
+s = "  Hello, World  "
+print(system_string.trim(s))
+print(system_string.upper(s) + "|" + system_string.lower(s))
+print(system_string.find(s, "World") + " " + system_string.find(s, "xyz"))
+print(system_string.count("banana", "an"))
+print(system_string.replace("a-b-c", "-", "+"))
+print(system_string.split("a,b,,c", ","))
@@ -0,0 +1,17 @@
+# Tail calls: `return f(...)`, also behind && / ||, run in constant stack.
+fn done(acc) {
+    print("counted " + acc)
+    return 1
+}
+fn count(n, acc) {
+    return n <= 0 && done(acc) || count(n - 1, acc + 1)
+}
+fn greet(name) {
+    return "hi " + name
+}
+fn relay(name) {
+    return greet(name)
+}
+print(count(11, 0))
+print(count(100000, 5))
+print(relay(relay("bob")))